@@ -1,5 +1,30 @@
+#ifndef GFX_C
+#define GFX_C
 #include <Arduino.h>
 
+// A run of consecutive code points whose glyphs are stored consecutively in a font
+struct FontRange {
+    uint16_t first;         // First code point in run
+    uint16_t last;          // Last code point in run
+    uint16_t glyphIndex;    // Glyph index of first code point
+};
+
+// Packed font. Glyph bitmaps are column-major, each column (height + 7) / 8 page bytes with the top row in bit 0 of the first byte.
+// Tables are stored in PROGMEM; fonts can be generated from BDF files with extras/bdf2font.py.
+struct Font {
+    uint8_t height;             // Glyph height in pixels
+    uint8_t spacing;            // Blank columns between glyphs
+    uint8_t fixedWidth;         // Width of every glyph for monospace fonts, or 0 if widths are per glyph
+    uint8_t rangeCount;         // Number of entries in ranges
+    const FontRange *ranges;    // Code point runs covered by the font
+    const uint8_t *widths;      // Per-glyph widths, or NULL for monospace fonts
+    const uint16_t *offsets;    // Per-glyph byte offsets into bitmaps, or NULL for monospace fonts
+    const uint8_t *bitmaps;     // Glyph column data
+    uint8_t indexFirst;         // Character code of the first index entry
+    uint8_t indexCount;         // Number of index entries
+    const uint8_t *index;       // Glyph index + 1 per character code with fallbacks resolved, 0 if none, or NULL to search ranges
+};
+
 const uint8_t alphabet_5x4_monospace[59][4] PROGMEM = {
     { 0x00, 0x00, 0x00, 0x00 }, // ' '
     { 0x00, 0x17, 0x00, 0x00 }, // !
@@ -125,6 +150,39 @@ const uint8_t alphabet_5x5_monospace[59][5] PROGMEM = {
     { 0x11, 0x19, 0x15, 0x13, 0x11 }  // Z
 };
 
+const FontRange basicLatinUpper[] PROGMEM = {
+    { ' ', 'Z', 0 }
+};
+
+// Glyph index + 1 for ' ' to 'z': lowercase letters map to uppercase and the symbols between them to a space
+constexpr uint8_t basicLatinUpperEntry(int code) {
+    return (code >= 'a') ? code - 'a' + 'A' - ' ' + 1 : (code <= 'Z') ? code - ' ' + 1 : 1;
+}
+
+#define BASIC_LATIN_UPPER_DECADE(c) \
+    basicLatinUpperEntry(c), basicLatinUpperEntry(c + 1), basicLatinUpperEntry(c + 2), basicLatinUpperEntry(c + 3), \
+    basicLatinUpperEntry(c + 4), basicLatinUpperEntry(c + 5), basicLatinUpperEntry(c + 6), basicLatinUpperEntry(c + 7), \
+    basicLatinUpperEntry(c + 8), basicLatinUpperEntry(c + 9)
+
+const uint8_t basicLatinUpperIndex['z' - ' ' + 1] PROGMEM = {
+    BASIC_LATIN_UPPER_DECADE(' '),
+    BASIC_LATIN_UPPER_DECADE(' ' + 10),
+    BASIC_LATIN_UPPER_DECADE(' ' + 20),
+    BASIC_LATIN_UPPER_DECADE(' ' + 30),
+    BASIC_LATIN_UPPER_DECADE(' ' + 40),
+    BASIC_LATIN_UPPER_DECADE(' ' + 50),
+    BASIC_LATIN_UPPER_DECADE(' ' + 60),
+    BASIC_LATIN_UPPER_DECADE(' ' + 70),
+    BASIC_LATIN_UPPER_DECADE(' ' + 80),
+    basicLatinUpperEntry('z')
+};
+
+#undef BASIC_LATIN_UPPER_DECADE
+
+const Font font_5x4_monospace = { 5, 1, 4, 1, basicLatinUpper, NULL, NULL, *alphabet_5x4_monospace, ' ', sizeof(basicLatinUpperIndex), basicLatinUpperIndex };
+
+const Font font_5x5_monospace = { 5, 1, 5, 1, basicLatinUpper, NULL, NULL, *alphabet_5x5_monospace, ' ', sizeof(basicLatinUpperIndex), basicLatinUpperIndex };
+
 const PROGMEM uint8_t batteryCase[] = {
   0x3E, 0x63, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x63, 0x3E, 0x08
 };
@@ -138,3 +196,5 @@ const PROGMEM uint8_t batteryMidCell = 0x1C;
 const PROGMEM uint8_t batteryHighCell[] = {
   0x1C, 0x08
 };
+
+#endif
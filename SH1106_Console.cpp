@@ -0,0 +1,110 @@
+#include "SH1106_Console.h"
+
+/*!
+    @brief  Instantiates a scrolling text console on a display. Each console line takes one 8 row page, so fonts up to
+            7 pixels high fit. Lines are kept in a ring buffer whose slots are the buffer pages, and the display start
+            line is moved to scroll, so a new line costs a single page transfer rather than a full frame.
+            Call clear() before first use.
+    @param  oled    Display to write to
+*/
+SH1106_Console::SH1106_Console(SH1106_OLED &oled) : oled(oled), topPage(0), lineCount(0), currentPage(0), length(0), newLinePending(true) {}
+
+
+/*!
+    @brief  Clears the screen and the console history, and resets the display start line.
+*/
+void SH1106_Console::clear() {
+    oled.clear();
+    oled.setStartLine(0);
+    topPage = 0;
+    lineCount = 0;
+    currentPage = 0;
+    length = 0;
+    newLinePending = true;
+}
+
+
+/*!
+    @brief  Clears the screen and draws the stored console lines again, for example after other content was drawn over them.
+*/
+void SH1106_Console::redraw() {
+    oled.clear();
+    for (uint8_t i = 0; i < lineCount; i++) {
+        drawLine((topPage + i) % (oled.getHeight() / 8));
+    }
+}
+
+
+/*!
+    @brief  Writes a character to the console. Long lines wrap, and a newline starts a new line when the next
+            character arrives so the bottom line is never left empty. The screen is not updated until display() is called.
+    @param  c   Character to write
+    @returns Number of characters written
+*/
+size_t SH1106_Console::write(uint8_t c) {
+    if (c == '\r') {
+        return 1;
+    }
+
+    if (c == '\n') {
+        newLinePending = true;
+        return 1;
+    }
+
+    if (newLinePending || length == CONSOLE_COLUMNS) {
+        newLine();
+    }
+
+    char *line = lines[currentPage];
+    line[length] = c;
+    line[length + 1] = '\0';
+    if (length > 0 && oled.getTextWidth(line) > oled.getWidth()) {
+        line[length] = '\0';
+        newLine();
+        line = lines[currentPage];
+        line[0] = c;
+        line[1] = '\0';
+    }
+
+    length++;
+    drawLine(currentPage);
+    return 1;
+}
+
+
+/*!
+    @brief  Starts a new console line, scrolling the oldest line off the top once the screen is full.
+*/
+void SH1106_Console::newLine() {
+    uint8_t pages = oled.getHeight() / 8;
+    if (lineCount < pages) {
+        currentPage = (topPage + lineCount) % pages;
+        lineCount++;
+    } else {
+        // The top line's page is cleared and becomes the bottom line
+        oled.scroll(8);
+        currentPage = topPage;
+        topPage = (topPage + 1) % pages;
+    }
+
+    lines[currentPage][0] = '\0';
+    length = 0;
+    newLinePending = false;
+}
+
+
+/*!
+    @brief  Draws a stored console line into its page of the buffer, inside the display's clip rectangle, which is left as it was.
+    @param  page    Buffer page holding the line
+*/
+void SH1106_Console::drawLine(uint8_t page) {
+    int16_t x1, y1, x2, y2;
+    oled.getClipRect(x1, y1, x2, y2);
+    int16_t top = max(y1, (int16_t)(page * 8));
+    int16_t bottom = min(y2, (int16_t)((page * 8) + 7));
+    if (top <= bottom) {
+        oled.setClipRect(x1, top, x2, bottom);
+        oled.print(lines[page], 0, page * 8);
+    }
+    oled.setClipRect(x1, y1, x2, y2);
+}
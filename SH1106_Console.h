@@ -0,0 +1,34 @@
+#ifndef SH1106_Console_h
+#define SH1106_Console_h
+
+#include "SH1106_OLED.h"
+
+// Characters stored per console line
+#ifndef CONSOLE_COLUMNS
+#define CONSOLE_COLUMNS 32
+#endif
+
+
+class SH1106_Console : public Print {
+    public:
+        SH1106_Console(SH1106_OLED &oled);
+
+        void clear();
+        void redraw();
+        virtual size_t write(uint8_t c);
+        using Print::write;
+
+    private:
+        void newLine();
+        void drawLine(uint8_t page);
+
+        SH1106_OLED &oled;
+        char lines[MAX_PAGES][CONSOLE_COLUMNS + 1];
+        uint8_t topPage;
+        uint8_t lineCount;
+        uint8_t currentPage;
+        uint8_t length;
+        bool newLinePending;
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include "SH1106_Manager.h"
+
+/*!
+    @brief  Instantiates a manager that shares the I2C bus between several SH1106 displays.
+            Displays may be at different addresses, behind channels of a TCA9548A-style I2C multiplexer, or both.
+    @param  muxAddress  I2C address of the multiplexer, used only by displays added with a mux channel
+*/
+SH1106_Manager::SH1106_Manager(uint8_t muxAddress) : mux(muxAddress), displayCount(0), active(NO_DISPLAY), lastServed(0), pool(NULL) {}
+
+
+/*!
+    @brief  Adds a display to the manager. Must be called before begin().
+            The display's transport is wrapped so that every command and data transfer selects its multiplexer channel
+            first, including sleep(), wake() and contrast changes made outside update().
+    @param  oled        Display to manage, not yet initialised
+    @param  interval    Minimum time between refreshes of this display in milliseconds, 0 to refresh whenever it has changes
+    @param  muxChannel  Multiplexer channel the display is wired to, or NO_MUX_CHANNEL if it is on the main bus
+    @returns Id of display, or NO_DISPLAY if the manager is full
+*/
+uint8_t SH1106_Manager::addDisplay(SH1106_OLED &oled, uint16_t interval, uint8_t muxChannel) {
+    if (displayCount == MAX_DISPLAYS) {
+        return NO_DISPLAY;
+    }
+
+    ManagedDisplay &display = displays[displayCount];
+    display.oled = &oled;
+    display.transport = SH1106_MuxTransport(&mux, muxChannel, &oled.getTransport());
+    oled.setTransport(display.transport);
+    display.interval = interval;
+    display.lastFlush = 0;
+
+    return displayCount++;
+}
+
+
+/*!
+    @brief  Initialises every display.
+    @param  shareBuffers    True to allocate the screen buffers of all displays that do not already have one as a single
+                            block, avoiding several separate heap allocations, false to let each display allocate its own
+    @returns Boolean true if every display was initialised, false if not
+*/
+bool SH1106_Manager::begin(bool shareBuffers) {
+    if (shareBuffers && !pool) {
+        uint16_t poolSize = 0;
+        for (uint8_t i = 0; i < displayCount; i++) {
+            if (!displays[i].oled->getBuffer()) {
+                poolSize += displays[i].oled->getBufferSize();
+            }
+        }
+
+        pool = poolSize ? (uint8_t *)malloc(poolSize) : NULL;
+        uint8_t *next = pool;
+        for (uint8_t i = 0; next && i < displayCount; i++) {
+            if (displays[i].oled->setBuffer(next)) {
+                next += displays[i].oled->getBufferSize();
+            }
+        }
+    }
+
+    bool ok = true;
+    for (uint8_t i = 0; i < displayCount; i++) {
+        ok &= displays[i].oled->init();
+    }
+
+    return ok;
+}
+
+
+/*!
+    @brief  Sends up to a fixed number of I2C transactions of pending display data, bounding the bus time spent per call.
+            One display is transferred at a time. When it finishes, the next is chosen from the displays with changes or
+            pending settings whose refresh interval has elapsed, most overdue first, then most changed, rotating between equals.
+    @param  maxTransactions     Largest number of data transactions to send in this call
+    @returns Boolean true if a transfer is still in progress, false if every display is up to date or waiting for its interval
+*/
+bool SH1106_Manager::update(uint8_t maxTransactions) {
+    while (maxTransactions) {
+        if (active == NO_DISPLAY) {
+            uint8_t next = pickNextDisplay(false);
+            if (next == NO_DISPLAY) {
+                return false;
+            }
+
+            startDisplay(next);
+            continue;
+        }
+
+        SH1106_OLED *oled = displays[active].oled;
+        if (oled->isBusy()) {
+            oled->pollDisplay();
+            maxTransactions--;
+        }
+
+        if (!oled->isBusy()) {
+            active = NO_DISPLAY;
+        }
+    }
+
+    return isBusy();
+}
+
+
+/*!
+    @brief  Sends all pending changes on every display, ignoring refresh intervals. Blocks until complete.
+*/
+void SH1106_Manager::displayAll() {
+    while (update(0xFF));
+
+    uint8_t next;
+    while ((next = pickNextDisplay(true)) != NO_DISPLAY) {
+        startDisplay(next);
+        while (update(0xFF));
+    }
+}
+
+
+/*!
+    @brief  Returns whether a display transfer is in progress.
+    @returns Boolean true if a transfer is in progress
+*/
+bool SH1106_Manager::isBusy() {
+    return active != NO_DISPLAY;
+}
+
+
+/*!
+    @brief  Returns the display currently being transferred.
+    @returns Id of display, or NO_DISPLAY if none
+*/
+uint8_t SH1106_Manager::getActiveDisplay() {
+    return active;
+}
+
+
+/*!
+    @brief  Chooses the next display to refresh.
+    @param  ignoreInterval  True to consider every display with changes or pending settings, regardless of its refresh interval
+    @returns Id of display, or NO_DISPLAY if none need refreshing
+*/
+uint8_t SH1106_Manager::pickNextDisplay(bool ignoreInterval) {
+    uint32_t now = millis();
+    uint8_t best = NO_DISPLAY;
+    uint32_t bestOverdue = 0;
+    uint16_t bestDirty = 0;
+
+    // Start after the last display served, so displays that are equally due take turns
+    for (uint8_t n = 1; n <= displayCount; n++) {
+        uint8_t i = (lastServed + n) % displayCount;
+        ManagedDisplay &display = displays[i];
+        uint16_t dirty = display.oled->getDirtyBytes();
+        uint32_t elapsed = now - display.lastFlush;
+        if ((dirty == 0 && !display.oled->hasPendingSettings()) || (!ignoreInterval && elapsed < display.interval)) {
+            continue;
+        }
+
+        uint32_t overdue = ignoreInterval ? 0 : elapsed - display.interval;
+        if (best == NO_DISPLAY || overdue > bestOverdue || (overdue == bestOverdue && dirty > bestDirty)) {
+            best = i;
+            bestOverdue = overdue;
+            bestDirty = dirty;
+        }
+    }
+
+    return best;
+}
+
+
+/*!
+    @brief  Starts the transfer of a display's changes.
+    @param  id  Id of display
+*/
+void SH1106_Manager::startDisplay(uint8_t id) {
+    displays[id].oled->beginDisplay();
+    displays[id].lastFlush = millis();
+    lastServed = id;
+    active = id;
+}
+
@@ -0,0 +1,44 @@
+#ifndef SH1106_Manager_h
+#define SH1106_Manager_h
+
+#include "SH1106_OLED.h"
+
+// Number of displays a manager can drive
+#ifndef MAX_DISPLAYS
+#define MAX_DISPLAYS 4
+#endif
+
+#define NO_DISPLAY 0xFF
+
+struct ManagedDisplay {
+    SH1106_OLED *oled;
+    SH1106_MuxTransport transport;
+    uint16_t interval;
+    uint32_t lastFlush;
+};
+
+
+class SH1106_Manager {
+    public:
+        SH1106_Manager(uint8_t muxAddress = DEFAULT_MUX_ADDRESS);
+
+        uint8_t addDisplay(SH1106_OLED &oled, uint16_t interval = 0, uint8_t muxChannel = NO_MUX_CHANNEL);
+        bool begin(bool shareBuffers = true);
+        bool update(uint8_t maxTransactions = 1);
+        void displayAll();
+        bool isBusy();
+        uint8_t getActiveDisplay();
+
+    private:
+        uint8_t pickNextDisplay(bool ignoreInterval);
+        void startDisplay(uint8_t id);
+
+        ManagedDisplay displays[MAX_DISPLAYS];
+        SH1106_Mux mux;
+        uint8_t displayCount;
+        uint8_t active;
+        uint8_t lastServed;
+        uint8_t *pool;
+};
+
+#endif
@@ -1,45 +1,107 @@
 #include "SH1106_OLED.h"
 
 /*!
-    @brief  Instantiates a SH1106_OLED screen object.
-    @param  width   Width of display in pixels
-    @param  height  Height of display in pixels
-    @param  address I2C address of SH1106 device
+    @brief  Instantiates a SH1106_OLED screen object on the default I2C bus.
+    @param  width           Width of display in pixels, up to 132
+    @param  height          Height of display in pixels, a multiple of 8 up to 64
+    @param  address         I2C address of SH1106 device on Wire
+    @param  orientation     ORIENTATION_NORMAL, or ORIENTATION_FLIPPED to rotate the image 180 degrees
+    @param  columnOffset    First of the SH1106's 132 RAM columns wired to the panel in normal orientation.
+                            Defaults to centring the panel, which gives 2 for 128 pixel wide panels and 0 for 132
 */
-SH1106_OLED::SH1106_OLED(uint8_t width, uint8_t height, uint8_t address) : width(width), height(height), address(address), bufferSize(width * height / 8) {}
+SH1106_OLED::SH1106_OLED(uint8_t width, uint8_t height, uint8_t address, Orientation orientation, uint8_t columnOffset) : SH1106_OLED(width, height, address, NULL, orientation, columnOffset) {}
+
+
+/*!
+    @brief  Instantiates a SH1106_OLED screen object using a given bus transport, such as SH1106_SPI or an SH1106_I2C on another TwoWire bus.
+    @param  width           Width of display in pixels, up to 132
+    @param  height          Height of display in pixels, a multiple of 8 up to 64
+    @param  transport       Transport to the SH1106, which must outlive the display
+    @param  orientation     ORIENTATION_NORMAL, or ORIENTATION_FLIPPED to rotate the image 180 degrees
+    @param  columnOffset    First of the SH1106's 132 RAM columns wired to the panel in normal orientation
+*/
+SH1106_OLED::SH1106_OLED(uint8_t width, uint8_t height, SH1106_Transport &transport, Orientation orientation, uint8_t columnOffset) : SH1106_OLED(width, height, 0, &transport, orientation, columnOffset) {}
+
+
+/*!
+    @brief  Instantiates a SH1106_OLED screen object, using the built in I2C transport on Wire when no transport is given.
+    @param  width           Width of display in pixels
+    @param  height          Height of display in pixels
+    @param  address         I2C address of SH1106 device, used when transport is NULL
+    @param  transport       Transport to the SH1106, or NULL to use I2C on Wire
+    @param  orientation     Display orientation
+    @param  columnOffset    First RAM column wired to the panel in normal orientation, or COLUMN_OFFSET_AUTO
+*/
+SH1106_OLED::SH1106_OLED(uint8_t width, uint8_t height, uint8_t address, SH1106_Transport *transport, Orientation orientation, uint8_t columnOffset) : width(width), height(height), i2c(address), transport(transport ? transport : &i2c), pages(height / 8), columnOffset(columnOffset == COLUMN_OFFSET_AUTO ? (SH1106_COLUMNS - width) / 2 : columnOffset), ramColumnOffset(0), orientation(orientation), buffer(NULL), frontBuffer(NULL), bufferSize(width * height / 8), diffMode(false), bytesSaved(0), flushPage(MAX_PAGES), flushRamPages(0), flushStartLine(0), flushRamRowOffset(0), remapPages(0), startLine(0), ramRowOffset(0), pendingSettings(0), contrast(0xFF), inverse(false), fading(false), fadeFrom(0xFF), fadeTo(0xFF), fadeDuration(0), fadeStart(0), asleep(false), chargePumpOn(false), chargePumpStart(0), font(&font_5x4_monospace), clipX1(0), clipY1(0), clipX2(width - 1), clipY2(height - 1), cursorX(0), cursorY(0), textScale(1), textRotated(false), glyphCache(NULL), glyphCacheTick(0), glyphCacheHits(0), glyphCacheMisses(0) {}
+
+
+// Initialisation commands that do not depend on the panel geometry
+static const uint8_t initCommands[] PROGMEM = {
+    0xAE, // Turn display off
+    0xD5, 0x80, // Set display clock divide ratio
+    0xD3, 0x00, // Set display offset
+    0x40, // Set display start line
+    0xAD, 0x8B, // Set charge pump
+    0xD9, 0x1F, // Set pre-charge period
+    0xDB, 0x40, // Set VCOMH deselect level
+    0x33, // Set VPP
+    0xA4 // Set all display on
+};
 
 
 /*!
     @brief  Initialises the SH1106 OLED screen display.
             Commands set according to datasheet - https://www.pololu.com/file/0J1813/SH1106.pdf
+            The multiplex ratio, COM pin layout and scan directions are derived from the panel geometry and orientation.
+            The configuration is sent as one command stream, and the display RAM is cleared while the charge pump settles,
+            so the display turns on as soon as the datasheet allows.
+    @returns Boolean true if the display was initialised, false if the geometry is unsupported or the buffer could not be allocated
 */
 bool SH1106_OLED::init() {
-    buffer = (uint8_t *)malloc(bufferSize);
+    if (width == 0 || width + columnOffset > SH1106_COLUMNS || height == 0 || height > MAX_PAGES * 8 || (height & 0x07)) {
+        return false;
+    }
+
+    if (!buffer) {
+        buffer = (uint8_t *)malloc(bufferSize);
+        if (!buffer) {
+            return false;
+        }
+    }
+
     memset(buffer, 0x00, bufferSize);
+    markAllDirty();
+
+    // Remapping the segments mirrors RAM columns, so a flipped panel is reached from the other end of RAM
+    bool flipped = orientation == ORIENTATION_FLIPPED;
+    ramColumnOffset = flipped ? SH1106_COLUMNS - width - columnOffset : columnOffset;
+
+    SH1106_CommandStream commands;
+    commands.addProgmem(initCommands, sizeof(initCommands));
+    commands.add(0xA8, height - 1); // Set multiplex ratio
+    commands.add(flipped ? 0xA0 : 0xA1); // Set segment re-map
+    commands.add(flipped ? 0xC0 : 0xC8); // Set COM output scan direction
+    commands.add(0xDA, height > 32 ? 0x12 : 0x02); // Set COM pins hardware config
+    commands.add(0x81, contrast); // Set contrast
+    commands.add(inverse ? 0xA7 : 0xA6); // Set normal/inverse display
+
+    transport->begin();
+    if (millis() < SH1106_POWER_ON_DELAY) {
+        delay(SH1106_POWER_ON_DELAY - millis());
+    }
+
+    sendCommands(commands);
+    chargePumpOn = true;
+    chargePumpStart = millis();
+    startLine = 0;
+    ramRowOffset = 0;
+    remapPages = 0;
+    pendingSettings = 0;
 
-    Wire.begin();
-    Wire.setClock(400000);
-    delay(100);
-
-    sendCommand(0xAE); // Turn display off
-    sendDualCommand(0xD5, 0x80); // Set display clock divide ratio
-    sendDualCommand(0xA8, 0x3F); // Set multiplex ratio
-    sendDualCommand(0xD3, 0x00); // Set display offset
-    sendCommand(0x40); // Set display start line
-    sendDualCommand(0xAD, 0x8B); // Set charge pump
-    sendCommand(0xA1); // Set segment re-map
-    sendCommand(0xC8); // Set COM output scan direction
-    sendDualCommand(0xDA, 0x12); // Set COM pins hardware config
-    sendDualCommand(0x81, 0xFF); // Set contrast
-    sendDualCommand(0xD9, 0x1F); // Set pre-charge period
-    sendDualCommand(0xDB, 0x40); // Set VCOMH deselect level
-    sendCommand(0x33); // Set VPP
-    sendCommand(0xA6); // Set normal/inverse display
-    sendCommand(0xA4); // Set all display on
-
-    delay(100);
     display();
-    sendCommand(0xAF); // Set all display on
+    waitForChargePump();
+    sendCommand(0xAF); // Turn display on
+    asleep = false;
 
     setFontSize(4);
 
@@ -48,36 +110,190 @@ bool SH1106_OLED::init() {
 
 
 /*!
-    @brief  Sends the display buffer to the SH1106 OLED screen module.
+    @brief  Puts the SH1106 into its power saving sleep mode. The display turns off but keeps its RAM contents,
+            so wake() restores the picture without resending it. Drawing and display() still work while asleep.
+    @param  keepChargePump  True to leave the charge pump running, so wake() is immediate at the cost of a higher sleep current,
+                            false to switch it off, so wake() must wait for it to settle again
+*/
+void SH1106_OLED::sleep(bool keepChargePump) {
+    SH1106_CommandStream commands;
+    commands.add(0xAE); // Turn display off
+    if (!keepChargePump && chargePumpOn) {
+        commands.add(0xAD, 0x8A); // Set charge pump off
+        chargePumpOn = false;
+    }
+
+    sendCommands(commands);
+    asleep = true;
+}
+
+
+/*!
+    @brief  Turns the display back on after sleep(). Pending changes are sent while the charge pump settles.
+            Blocks until the display is on.
+*/
+void SH1106_OLED::wake() {
+    if (!asleep) {
+        return;
+    }
+
+    if (!chargePumpOn) {
+        sendDualCommand(0xAD, 0x8B); // Set charge pump on
+        chargePumpOn = true;
+        chargePumpStart = millis();
+    }
+
+    display();
+    waitForChargePump();
+    sendCommand(0xAF); // Turn display on
+    asleep = false;
+}
+
+
+/*!
+    @brief  Returns whether the display is in sleep mode.
+    @returns Boolean true if sleep() has been called without a matching wake()
+*/
+bool SH1106_OLED::isAsleep() {
+    return asleep;
+}
+
+
+/*!
+    @brief  Sends the modified regions of the display buffer to the SH1106 OLED screen module.
+            Pages with no changes since the last call are skipped, and only the dirty column span of each other page is sent.
+            Blocks until the whole transfer is complete; see beginDisplay() for the incremental equivalent.
 */
 void SH1106_OLED::display() {
-    for(int i = 0; i < 8; i++) {
-        uint8_t cmd[] = {
-            0x00,
-            (uint8_t)(0xB0 + i),
-            (uint8_t)(0x10),
-            (uint8_t)(0x02)
-        };
-
-        Wire.beginTransmission(address);
-        Wire.write(cmd, 4); 
-        Wire.endTransmission();
-
-        Wire.beginTransmission(address);
-        Wire.write(0x40);
-        uint8_t bytesWritten = 1;
-        for(int j = 0; j < 128; j++) {
-            Wire.write(buffer[j + (i * 128)]);
-            bytesWritten++;
-            if (bytesWritten == WIRE_MAX) {
-                Wire.endTransmission(false);
-                Wire.beginTransmission(address);
-                Wire.write(0x40);
-                bytesWritten = 1;
+    beginDisplay();
+    while (pollDisplay());
+}
+
+
+/*!
+    @brief  Starts an incremental transfer of the modified regions of the display buffer.
+            The dirty spans are captured at this point, so anything drawn afterwards is sent by the next transfer.
+            With double buffering enabled the buffers are swapped and the finished frame is streamed from the front buffer,
+            and the spans being sent are copied back into the new drawing buffer, so drawing carries on from the frame just finished.
+            Call pollDisplay() repeatedly to send the data. Any transfer still in progress is completed first.
+*/
+void SH1106_OLED::beginDisplay() {
+    while (pollDisplay());
+
+    if (frontBuffer) {
+        uint8_t *drawnFrame = buffer;
+        buffer = frontBuffer;
+        frontBuffer = drawnFrame;
+    }
+
+    for (uint8_t i = 0; i < pages; i++) {
+        flushStart[i] = dirtyStart[i];
+        flushEnd[i] = dirtyEnd[i];
+        // Pages moving to other RAM pages for a new start line are sent whole, even if their contents are unchanged
+        if (frontBuffer && diffMode && !(remapPages & (0x01 << i))) {
+            findChangedSpan(i);
+        }
+
+        if (flushStart[i] > flushEnd[i]) {
+            bytesSaved += width;
+        } else {
+            bytesSaved += width - (flushEnd[i] - flushStart[i] + 1);
+            if (frontBuffer) {
+                // Only the dirty spans can differ from the previous frame, which the drawing buffer now holds
+                uint16_t offset = flushStart[i] + (i * width);
+                memcpy(buffer + offset, frontBuffer + offset, flushEnd[i] - flushStart[i] + 1);
+            }
+        }
+
+        dirtyStart[i] = 0xFF;
+        dirtyEnd[i] = 0;
+    }
+
+    remapPages = 0;
+    flushStartLine = startLine;
+    flushRamRowOffset = ramRowOffset;
+    flushPage = 0;
+    flushRamPages = 0;
+    seekFlushPage();
+    if (flushPage >= pages) {
+        sendPendingSettings();
+    }
+}
+
+
+/*!
+    @brief  Sends the next chunk of a transfer started with beginDisplay().
+            Each call performs at most one bus transaction, of up to WIRE_MAX bytes on I2C, bounding the time spent per call.
+            While a background transport is still sending the previous chunk, returns without sending anything.
+    @returns Boolean true if more data remains to be sent, and false once the transfer is complete
+*/
+bool SH1106_OLED::pollDisplay() {
+    if (!isBusy()) {
+        return false;
+    }
+
+    if (transport->isBusy() || flushPage >= pages) {
+        return true;
+    }
+
+    uint8_t *source = frontBuffer ? frontBuffer : buffer;
+    uint8_t *data = source + flushColumn + (flushPage * width);
+    uint16_t remaining = flushEnd[flushPage] - flushColumn + 1;
+    uint8_t ramPage = 0;
+    while (!(flushRamPages & (0x01 << ramPage))) {
+        ramPage++;
+    }
+
+    flushColumn += transport->sendData(ramPage, flushColumn + ramColumnOffset, data, remaining);
+
+    if (flushColumn > flushEnd[flushPage]) {
+        // A page the start line falls inside is sent to two RAM pages on panels shorter than 64 rows
+        flushRamPages &= ~(0x01 << ramPage);
+        if (flushRamPages) {
+            flushColumn = flushStart[flushPage];
+        } else {
+            flushPage++;
+            seekFlushPage();
+            if (flushPage >= pages) {
+                sendPendingSettings();
             }
         }
-        Wire.endTransmission(true);
     }
+
+    return isBusy();
+}
+
+
+/*!
+    @brief  Returns whether a transfer started with beginDisplay() still has data to send, or is still being sent by a background transport.
+    @returns Boolean true if a transfer is in progress
+*/
+bool SH1106_OLED::isBusy() {
+    return flushPage < pages || transport->isBusy();
+}
+
+
+/*!
+    @brief  Allocates a second framebuffer so drawing never touches the frame being sent to the screen.
+            Each display() swaps the buffers and copies the changed spans back, so the drawing buffer always starts out holding
+            the frame just sent and may be drawn over incrementally. Costs an extra width * height / 8 bytes of RAM.
+    @param  diff    If true, each transfer compares the two buffers and sends only the bytes that changed
+    @returns Boolean true if the back buffer is available, and false if it could not be allocated
+*/
+bool SH1106_OLED::enableDoubleBuffer(bool diff) {
+    diffMode = diff;
+    if (frontBuffer) {
+        return true;
+    }
+
+    display();
+    frontBuffer = (uint8_t *)malloc(bufferSize);
+    if (!frontBuffer) {
+        return false;
+    }
+
+    memcpy(frontBuffer, buffer, bufferSize);
+    return true;
 }
 
 
@@ -88,8 +304,12 @@ void SH1106_OLED::display() {
     @returns Boolean true if on, and false if off
 */
 bool SH1106_OLED::getPixel(uint8_t x, uint8_t y) {
+    if (x >= width || y >= height) {
+        return false;
+    }
+
     uint16_t bufferIndex = x + ((y / 8) * width);
-    return (buffer[bufferIndex] >> y) & 0x01;
+    return (buffer[bufferIndex] >> (y & 0x07)) & 0x01;
 }
 
 
@@ -99,8 +319,13 @@ bool SH1106_OLED::getPixel(uint8_t x, uint8_t y) {
     @param  y   y coordinate of pixel
 */
 void SH1106_OLED::setPixel(uint8_t x, uint8_t y) {
+    if (x < clipX1 || x > clipX2 || y < clipY1 || y > clipY2) {
+        return;
+    }
+
     uint16_t bufferIndex = x + ((y / 8) * width);
     buffer[bufferIndex] |= (0x01 << (y & 0x07));
+    markDirty(x, x, y / 8);
 }
 
 
@@ -110,8 +335,13 @@ void SH1106_OLED::setPixel(uint8_t x, uint8_t y) {
     @param  y   y coordinate of pixel
 */
 void SH1106_OLED::clearPixel(uint8_t x, uint8_t y) {
+    if (x < clipX1 || x > clipX2 || y < clipY1 || y > clipY2) {
+        return;
+    }
+
     uint16_t bufferIndex = x + ((y / 8) * width);
     buffer[bufferIndex] &= ~(0x01 << (y & 0x07));
+    markDirty(x, x, y / 8);
 }
 
 
@@ -121,8 +351,30 @@ void SH1106_OLED::clearPixel(uint8_t x, uint8_t y) {
     @param  y   y coordinate of pixel
 */
 void SH1106_OLED::invertPixel(uint8_t x, uint8_t y) {
+    if (x < clipX1 || x > clipX2 || y < clipY1 || y > clipY2) {
+        return;
+    }
+
     uint16_t bufferIndex = x + ((y / 8) * width);
     buffer[bufferIndex] ^= (0x01 << (y & 0x07));
+    markDirty(x, x, y / 8);
+}
+
+
+/*!
+    @brief  Sets a pixel given signed coordinates, skipping it if it is outside the clip rectangle, so shapes can plot
+            points off any edge without them wrapping around.
+    @param  x   x coordinate of pixel
+    @param  y   y coordinate of pixel
+*/
+void SH1106_OLED::plotClipped(int16_t x, int16_t y) {
+    if (x < clipX1 || x > clipX2 || y < clipY1 || y > clipY2) {
+        return;
+    }
+
+    uint16_t bufferIndex = x + ((y / 8) * width);
+    buffer[bufferIndex] |= (0x01 << (y & 0x07));
+    markDirty(x, x, y / 8);
 }
 
 
@@ -131,390 +383,1356 @@ void SH1106_OLED::invertPixel(uint8_t x, uint8_t y) {
 */
 void SH1106_OLED::clear() {
     memset(buffer, 0x00, bufferSize);
+    markAllDirty();
 }
 
 
 /*!
-    @brief  Inverts all values of the screen buffer.
+    @brief  Inverts all values of the screen buffer. To invert what is shown without changing the buffer, use setInverse().
 */
 void SH1106_OLED::invert() {
     for(int i = 0; i < bufferSize; i++) {
         buffer[i] = ~buffer[i];
     }
+
+    markAllDirty();
 }
 
 
 /*!
-    @brief  Sets font pointer based on width size. Defaults to size 4 if specified size not supported.
-    @param  size    Desired font size
+    @brief  Sets which buffer row is shown on the top row of the screen. Screen row r then shows buffer row
+            (r + line) % height, so drawing coordinates still address the buffer. The change is sent at the end of
+            the next display(), after the buffer contents, so new contents and the new offset appear together.
+            Pages whose place in the SH1106's RAM changes are resent, which only happens on panels shorter than 64 rows.
+    @param  line    Buffer row to show at the top of the screen
 */
-void SH1106_OLED::setFontSize(uint8_t size) {
-    fontSize = size;
-    if (size == 5) {
-        fontSet = *alphabet_5x5_monospace;
-    } else {
-        fontSet = *alphabet_5x4_monospace;
-    }
+void SH1106_OLED::setStartLine(uint8_t line) {
+    moveStartLine(line % height, ramRowOffset);
 }
 
 
 /*!
-    @brief  Write a message string starting at specified x, y position. Uses current font.
-    @param  msg     Message to write to screen buffer
-    @param  x       x coordinate corresponding to top left position of text start
-    @param  y       y coordinate corresponding to top left position of text start
+    @brief  Returns the buffer row shown on the top row of the screen.
+    @returns Display start line
 */
-void SH1106_OLED::print(String msg, uint8_t x, uint8_t y) {
-    int fontWidthInc = (fontSize + 1);
-    int messageLength = msg.length() * fontWidthInc - 1;
-    uint16_t *message = (uint16_t *)malloc(messageLength * 2);
-    memset(message, 0, messageLength * 2);
-    msg.toUpperCase();
+uint8_t SH1106_OLED::getStartLine() {
+    return startLine;
+}
 
-    for (int i = 0; i < msg.length(); i++) {
-        char s = msg[i];
-        uint8_t letterIndex = (uint8_t)s - (uint8_t)(' ');
-        for(int j = 0; j < fontSize; j++) {
-            uint8_t b = pgm_read_byte(&fontSet[letterIndex*fontSize] + j);
-            message[(i*fontWidthInc) + j] = (uint16_t)b;
-        }
+
+/*!
+    @brief  Scrolls the screen vertically in hardware by moving the display start line.
+            Only the rows scrolled into view are cleared and marked for sending, so the next display()
+            transfers just those pages instead of the whole buffer.
+    @param  lines   Rows to scroll by, positive to move contents up and negative to move them down
+*/
+void SH1106_OLED::scroll(int8_t lines) {
+    lines %= (int8_t)height;
+    if (lines == 0) {
+        return;
     }
 
-    int bufferIndex = x + ((y / 8) * width);
-    for (int i = 0; i < messageLength; i++) {
-        buffer[bufferIndex + i] |= (*(message + i) << (y & 0x07)) & 0xFF;
-        if ((y / 8) < (y + fontSize) / 8) {
-            buffer[bufferIndex + i + width] = ((*(message + i) << (y & 0x07)) >> 8) & 0xFF;
-        }
+    int16_t newStartLine = startLine + lines;
+    uint8_t newRamRowOffset = ramRowOffset;
+    if (newStartLine >= height) {
+        // Moving the RAM rows along with a wrapping start line keeps the rows already sent where they are
+        newStartLine -= height;
+        newRamRowOffset = (ramRowOffset + height) % SH1106_RAM_ROWS;
+    } else if (newStartLine < 0) {
+        newStartLine += height;
+        newRamRowOffset = (ramRowOffset + SH1106_RAM_ROWS - height) % SH1106_RAM_ROWS;
     }
 
-    delete(message);
+    if (lines > 0) {
+        // The rows that were at the top wrap round to become the bottom rows
+        clearRows(startLine, lines);
+    } else {
+        clearRows(newStartLine, -lines);
+    }
+
+    moveStartLine(newStartLine, newRamRowOffset);
 }
 
 
 /*!
-    @brief  Draws a bitmap of specified width and height to the screen buffer.
-    @param  bitmap          Pointer to uint8_t specifying beginning address of bitmap array
-    @param  x               x coordinate corresponding to top left position of bitmap start
-    @param  y               y coordinate corresponding to top left position of bitmap start
-    @param  bitmapWidth     Width of bitmap
-    @param  bitmapHeight    Height of bitmap
+    @brief  Moves the display start line, marking the pages that move to other RAM pages for sending.
+            The SH1106 start line register wraps at the 64 RAM rows, not at the panel height. Buffer rows from the
+            start line down are kept at RAM row (row + ramRowOffset) % 64, and the rows above it one panel height
+            further on, so setting the register to (line + ramRowOffset) % 64 shows the buffer rows in order.
+    @param  line            Buffer row to show at the top of the screen
+    @param  newRamRowOffset RAM row of buffer row 0, a multiple of 8
 */
-void SH1106_OLED::drawBitmap(uint8_t *bitmap, uint8_t x, uint8_t y, uint8_t bitMapWidth, uint8_t bitMapHeight) {
-    if (bitMapWidth * bitMapHeight == 0) {
-        return;
-    }
-
-    uint8_t verticalOffset = y & 0x07;
-    uint8_t pageCount = (bitMapHeight / 8) + (bitMapHeight % 8 != 0);
-    uint16_t bufferIndex = x + (y / 8) * width;
-
-    for (uint8_t j = 0; j < pageCount; j++) {
-        for (uint8_t i = 0; i < bitMapWidth; i++) {
-            uint8_t byteToWrite = pgm_read_byte(bitmap + i + (j * bitMapWidth));
-            buffer[bufferIndex + i + (j * width)] |= byteToWrite << verticalOffset;
-            if (verticalOffset) {
-                buffer[bufferIndex + i + ((j + 1) * width)] |= byteToWrite >> (8 - verticalOffset);
-            }
+void SH1106_OLED::moveStartLine(uint8_t line, uint8_t newRamRowOffset) {
+    for (uint8_t page = 0; page < pages; page++) {
+        if (getRamPages(page, line, newRamRowOffset) != getRamPages(page, startLine, ramRowOffset)) {
+            markDirty(0, width - 1, page);
+            remapPages |= 0x01 << page;
         }
     }
+
+    startLine = line;
+    ramRowOffset = newRamRowOffset;
+    pendingSettings |= PENDING_START_LINE;
 }
 
 
 /*!
-    @brief  Draws horizontal line from x1 to x2 at vertical position y.
-    @param  x1  Starting x coordinate of line
-    @param  x2  Ending x coordinate of line
-    @param  y   Vertical position of line
+    @brief  Switches the SH1106 between normal and inverse display in hardware, leaving the screen buffer unchanged.
+            Only a command is sent, at the end of the next display().
+    @param  inverse     True to show lit pixels as dark and dark pixels as lit, false for normal display
 */
-void SH1106_OLED::drawHLine(uint8_t x1, uint8_t x2, uint8_t y) {
-    clamp(x1, 0, width - 1);
-    clamp(x2, 0, width - 1);
-    clamp(y, 0, height - 1);
+void SH1106_OLED::setInverse(bool inverse) {
+    this->inverse = inverse;
+    pendingSettings |= PENDING_INVERSE;
+}
 
-    uint8_t xMin = x1;
-    uint8_t distance = x2 - x1;
-    if (x2 < x1) {
-        xMin = x2;
-        distance = x1 - x2;
-    }
 
-    int minBufferIndex = (y / 8) * width + xMin;
+/*!
+    @brief  Returns whether the display is set to inverse in hardware.
+    @returns Boolean true if inverse display is set
+*/
+bool SH1106_OLED::isInverse() {
+    return inverse;
+}
+
 
-    if (distance == 0) {
-        buffer[minBufferIndex] |= 0x01 << (y & 0x07);
+/*!
+    @brief  Rotates the display 180 degrees in hardware by reversing the segment and COM scan directions.
+            Takes effect at the end of the next display(). The buffer is unchanged, and only needs resending
+            if the panel is not centred in the SH1106's RAM, as the flipped panel is then reached at different RAM columns.
+    @param  newOrientation  ORIENTATION_NORMAL, or ORIENTATION_FLIPPED to rotate the image 180 degrees
+*/
+void SH1106_OLED::setOrientation(Orientation newOrientation) {
+    if (newOrientation == orientation) {
         return;
     }
 
-    for (int i = 0; i <= distance; i++) {
-        buffer[minBufferIndex + i] |= 0x01 << (y & 0x07);
+    orientation = newOrientation;
+    uint8_t newRamColumnOffset = orientation == ORIENTATION_FLIPPED ? SH1106_COLUMNS - width - columnOffset : columnOffset;
+    if (newRamColumnOffset != ramColumnOffset) {
+        ramColumnOffset = newRamColumnOffset;
+        markAllDirty();
     }
+
+    pendingSettings |= PENDING_ORIENTATION;
 }
 
 
 /*!
-    @brief  Draws vertical line from y1 to y2 at horizontal position x.
-    @param  y1  Starting y coordinate of line
-    @param  y2  Ending y coordinate of line
-    @param  x   Horizontal position of line
+    @brief  Returns the display orientation.
+    @returns ORIENTATION_NORMAL or ORIENTATION_FLIPPED
 */
-void SH1106_OLED::drawVLine(uint8_t y1, uint8_t y2, uint8_t x) {
-    clamp(y1, 0, height - 1);
-    clamp(y2, 0, height - 1);
-    clamp(x, 0, width - 1);
+Orientation SH1106_OLED::getOrientation() {
+    return orientation;
+}
 
-    uint8_t yMin = y1;
-    uint8_t distance = y2 - y1;
-    if (y2 < y1) {
-        yMin = y2;
-        distance = y1 - y2;
-    }
 
-    uint8_t yMax = yMin + distance;
-    uint8_t byteDistance = (yMax / 8) - (yMin / 8);
-    int minBufferIndex = (yMin / 8) * width + x;
+/*!
+    @brief  Sets the display contrast, which controls its brightness. Sent at the end of the next display().
+            Stops any fade in progress.
+    @param  value   Contrast from 0 to 255
+*/
+void SH1106_OLED::setContrast(uint8_t value) {
+    fading = false;
+    contrast = value;
+    pendingSettings |= PENDING_CONTRAST;
+}
 
-    if (distance == 0) {
-        buffer[minBufferIndex] |= 0x01 << (y1 & 0x07);
-        return;
-    }
 
-    uint8_t firstByte = 0xFF;
-    if (byteDistance == 0 && distance < 8) {
-        firstByte = 0x01;
-        for (int i = 0; i < distance; i++) {
-            firstByte <<= 1;
-            firstByte ^= 0x01;
-        }
-    }
+/*!
+    @brief  Returns the display contrast, which during a fade is the value most recently set by updateContrastFade().
+    @returns Contrast from 0 to 255
+*/
+uint8_t SH1106_OLED::getContrast() {
+    return contrast;
+}
 
-    buffer[minBufferIndex] |= firstByte << (yMin & 0x07);
-    
-    for (int i = 1; i < byteDistance; i++) {
-        buffer[minBufferIndex + (i * width)] = 0xFF;
-    }
 
-    if (byteDistance > 0) {
-        int maxBufferIndex = (yMax / 8) * width + x;
-        buffer[maxBufferIndex] |= 0xFF >> (7 - (yMax & 0x07));
-    }
+/*!
+    @brief  Starts a linear fade of the contrast from its current value to a target value.
+            The fade runs in the background: call updateContrastFade() regularly, for example once per loop, to advance it.
+    @param  target      Contrast to end at, from 0 to 255
+    @param  duration    Length of fade in milliseconds
+*/
+void SH1106_OLED::fadeContrast(uint8_t target, uint16_t duration) {
+    fadeFrom = contrast;
+    fadeTo = target;
+    fadeDuration = duration;
+    fadeStart = millis();
+    fading = true;
+    updateContrastFade();
 }
 
 
 /*!
-    @brief  Draws a line from position x1, y1 to position x2, y2.
-    @param  x1  x coordinate of line starting point
-    @param  y1  y coordinate of line starting point
-    @param  x2  x coordinate of line ending point
-    @param  y2  y coordinate of line ending point
+    @brief  Advances a fade started with fadeContrast(), sending the contrast command only when the value has changed.
+            Does not block. If a transfer is in progress the new contrast is sent when it finishes.
+    @returns Boolean true if the fade is still in progress, false once it has finished
 */
-void SH1106_OLED::drawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
-    if (y1 == y2) {
-        drawHLine(x1, x2, y1);
-        return;
+bool SH1106_OLED::updateContrastFade() {
+    if (!fading) {
+        return false;
     }
 
-    if (x1 == x2) {
-        drawVLine(y1, y2, x1);
-        return;
+    uint32_t elapsed = millis() - fadeStart;
+    uint8_t value;
+    if (elapsed >= fadeDuration) {
+        value = fadeTo;
+        fading = false;
+    } else {
+        value = fadeFrom + ((int32_t)(fadeTo - fadeFrom) * (int32_t)elapsed) / fadeDuration;
     }
 
-    int8_t xDistance = x2 - x1;
-    int8_t yDistance = y2 - y1;
-    float gradient = yDistance / (float)xDistance;
-
-    if (gradient <= 1 && gradient >= -1) {
-        for (int8_t i = 0; i <= abs(xDistance); i++) {
-            int8_t xIncrement = i * sign(xDistance);
-            uint8_t yValue = (gradient * xIncrement) + y1 + 0.5;
-            setPixel(xIncrement + x1, yValue);
-        }
-    } else {
-        for (int8_t i = 0; i <= abs(yDistance); i++) {
-            int8_t yIncrement = i * sign(yDistance);
-            uint8_t xValue = (yIncrement / gradient) + x1 + 0.5;
-            setPixel(xValue, yIncrement + y1);
+    if (value != contrast) {
+        contrast = value;
+        if (isBusy()) {
+            pendingSettings |= PENDING_CONTRAST;
+        } else {
+            sendDualCommand(0x81, contrast); // Set contrast
+            pendingSettings &= ~PENDING_CONTRAST;
         }
     }
+
+    return fading;
 }
 
 
 /*!
-    @brief  Draws a rectange at position x, y with specified width and height.
-    @param  x   Horizontal position of top left corner of rectangle
-    @param  y   Vertical position of top left corner of rectangle
-    @param  w   Width of rectangle in pixels
-    @param  h   Height of rectangle in pixels
+    @brief  Selects one of the built-in monospace fonts by glyph width. Defaults to size 4 if specified size not supported.
+    @param  size    Desired font size
 */
-void SH1106_OLED::drawRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
-    drawHLine(x, x + w, y);
-    drawHLine(x, x + w, y + h);
-    drawVLine(y, y + h, x);
-    drawVLine(y, y + h, x + w);
+void SH1106_OLED::setFontSize(uint8_t size) {
+    if (size == 5) {
+        font = &font_5x5_monospace;
+    } else {
+        font = &font_5x4_monospace;
+    }
 }
 
 
 /*!
-    @brief  Draws a filled rectange at position x, y with specified width and height.
-    @param  x   Horizontal position of top left corner of rectangle
-    @param  y   Vertical position of top left corner of rectangle
-    @param  w   Width of rectangle in pixels
-    @param  h   Height of rectangle in pixels
+    @brief  Selects the font used for text, e.g. one generated from a BDF file by extras/bdf2font.py.
+    @param  newFont     Font to use
 */
-void SH1106_OLED::drawRectFill(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
-    for (int i = 0; i <= h; i++) {
-        drawHLine(x, x + w, y + i);
-    }
+void SH1106_OLED::setFont(const Font *newFont) {
+    font = newFont;
 }
 
 
 /*!
-    @brief  Draws a rectange with rounded corners at position x, y with specified width and height and corner radius.
-    @param  x   Horizontal position of top left corner of rectangle
-    @param  y   Vertical position of top left corner of rectangle
-    @param  w   Width of rectangle in pixels
-    @param  h   Height of rectangle in pixels
-    @param  r   Radius of rounded corners
+    @brief  Write a message string starting at specified x, y position. Uses current font.
+            Glyphs are copied straight from the font table into the screen buffer, without any heap allocation.
+    @param  msg     Null-terminated message to write to screen buffer
+    @param  x       x coordinate corresponding to top left position of text start
+    @param  y       y coordinate corresponding to top left position of text start
 */
-void SH1106_OLED::drawRoundedRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t r) {
-    r = getClampedRadius(w, h, r);
-
-    drawHLine(x + r, x + w - r, y);
-    drawHLine(x + r, x + w - r, y + h);
-    drawVLine(y + r, y + h - r, x);
-    drawVLine(y + r, y + h - r, x + w);
-
-    drawArc(x + r, y + r, r, TOP_LEFT);
-    drawArc(x + w - r, y + r, r, TOP_RIGHT);
-    drawArc(x + r, y + h - r, r, BOTTOM_LEFT);
-    drawArc(x + w - r, y + h - r, r, BOTTOM_RIGHT);
+void SH1106_OLED::print(const char *msg, uint8_t x, uint8_t y) {
+    setCursor(x, y);
+    while (*msg) {
+        write(*msg++);
+    }
 }
 
 
 /*!
-    @brief  Draws a filled rectange with rounded corners at position x, y with specified width and height and corner radius.
-    @param  x   Horizontal position of top left corner of rectangle
-    @param  y   Vertical position of top left corner of rectangle
-    @param  w   Width of rectangle in pixels
-    @param  h   Height of rectangle in pixels
-    @param  r   Radius of rounded corners
+    @brief  Write a message string stored in flash (e.g. F("text")) starting at specified x, y position. Uses current font.
+    @param  msg     Flash string to write to screen buffer
+    @param  x       x coordinate corresponding to top left position of text start
+    @param  y       y coordinate corresponding to top left position of text start
 */
-void SH1106_OLED::drawRoundedRectFill(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t r) {
-    r = getClampedRadius(w, h, r);
+void SH1106_OLED::print(const __FlashStringHelper *msg, uint8_t x, uint8_t y) {
+    const char *p = (const char *)msg;
+    setCursor(x, y);
 
-    for (int i = 0; i <= r; i++) {
-        drawHLine(x + r, x + w - r, y + i);
-        drawHLine(x + r, x + w - r, y + h - i);
+    char c;
+    while ((c = pgm_read_byte(p++))) {
+        write(c);
     }
+}
 
-    for (int i = 0; i <= (h - 2 * r); i++) {
-        drawHLine(x, x + w, y + r + i);
-    }
 
-    drawArcFill(x + r, y + r, r, TOP_LEFT);
-    drawArcFill(x + w - r, y + r, r, TOP_RIGHT);
-    drawArcFill(x + r, y + h - r, r, BOTTOM_LEFT);
-    drawArcFill(x + w - r, y + h - r, r, BOTTOM_RIGHT);
+/*!
+    @brief  Write a message string starting at specified x, y position. Uses current font.
+    @param  msg     Message to write to screen buffer
+    @param  x       x coordinate corresponding to top left position of text start
+    @param  y       y coordinate corresponding to top left position of text start
+*/
+void SH1106_OLED::print(const String &msg, uint8_t x, uint8_t y) {
+    print(msg.c_str(), x, y);
 }
 
 
 /*!
-    @brief  Draws a circle with centre at xCentre, yCentre position, with specified radius.
-            Shoutout to Adafruit for the sick circle algorithm
-    @param  xCentre     Centre x coordinate of circle
-    @param  yCentre     Centre y coordinate of circle
-    @param  radius      Radius of circle
+    @brief  Writes a message inside a box, word-wrapping it to the box width and clipping anything outside the box.
+            Lines break at spaces where possible, at any character when a single word is wider than the box, and at newlines.
+            Lines are aligned by their width without trailing spaces.
+            Text is scaled by the current text scale but always laid out unrotated.
+    @param  msg     Null-terminated message to write to screen buffer
+    @param  x       x coordinate of left of box
+    @param  y       y coordinate of top of box
+    @param  w       Width of box in pixels
+    @param  h       Height of box in pixels
+    @param  align   Horizontal alignment of each line within the box
 */
-void SH1106_OLED::drawCircle(uint8_t xCentre, uint8_t yCentre, uint8_t radius) {
-    int16_t f = 1 - radius;
-    int16_t ddF_x = 1;
-    int16_t ddF_y = -2 * radius;
-    int16_t x = 0;
-    int16_t y = radius;
+void SH1106_OLED::printBox(const char *msg, uint8_t x, uint8_t y, uint8_t w, uint8_t h, TextAlign align) {
+    uint8_t savedClip[4] = { clipX1, clipY1, clipX2, clipY2 };
+    bool savedRotation = textRotated;
+    textRotated = false;
+    clipX1 = max(clipX1, x);
+    clipY1 = max(clipY1, y);
+    clipX2 = min((int16_t)clipX2, (int16_t)(x + w - 1));
+    clipY2 = min((int16_t)clipY2, (int16_t)(y + h - 1));
+
+    const uint8_t *glyph;
+    int16_t lineY = y;
+    while (w && h && clipX1 <= clipX2 && clipY1 <= clipY2 && *msg && lineY < y + h) {
+        // Find the longest run of whole words that fits, measuring as we go
+        const char *p = msg;
+        const char *lineEnd = msg;
+        uint16_t runWidth = 0;
+        uint16_t lineWidth = 0;
+        while (*p && *p != '\n') {
+            uint16_t nextWidth = runWidth + ((p == msg ? 0 : font->spacing) + findGlyph(*p, &glyph)) * textScale;
+            if (nextWidth > w) {
+                break;
+            }
 
-    setPixel(xCentre, yCentre + radius);
-    setPixel(xCentre, yCentre - radius);
-    setPixel(xCentre + radius, yCentre);
-    setPixel(xCentre - radius, yCentre);
+            runWidth = nextWidth;
+            p++;
+            if (*p == ' ' || *p == '\n' || !*p) {
+                // Trailing spaces are not part of the width the line is aligned by, so only the first of a run counts
+                lineEnd = p;
+                if (p[-1] != ' ') {
+                    lineWidth = runWidth;
+                }
+            }
+        }
 
-    while (x < y) {
-        if (f >= 0) {
-            y--;
-            ddF_y += 2;
-            f += ddF_y;
+        if (lineEnd == msg && *p && *p != '\n') {
+            // No whole word fits, so break mid-word, always taking at least one character
+            if (p == msg) {
+                p++;
+                runWidth = w;
+            }
+
+            lineEnd = p;
+            lineWidth = runWidth;
+        }
+
+        int16_t lineX = x;
+        if (align == ALIGN_CENTRE) {
+            lineX += (w - lineWidth) / 2;
+        } else if (align == ALIGN_RIGHT) {
+            lineX += w - lineWidth;
+        }
+
+        for (; msg < lineEnd; msg++) {
+            lineX += (drawChar(*msg, lineX, lineY) + font->spacing) * textScale;
+        }
+
+        if (*msg == '\n') {
+            msg++;
+        } else {
+            while (*msg == ' ') {
+                msg++;
+            }
+        }
+
+        lineY += (font->height + 1) * textScale;
+    }
+
+    textRotated = savedRotation;
+    clipX1 = savedClip[0];
+    clipY1 = savedClip[1];
+    clipX2 = savedClip[2];
+    clipY2 = savedClip[3];
+}
+
+
+/*!
+    @brief  Measures the width of a message in the current font and text scale, up to the end of the string or the first newline.
+    @param  msg     Null-terminated message to measure
+    @returns Width of message in pixels
+*/
+uint16_t SH1106_OLED::getTextWidth(const char *msg) {
+    const uint8_t *glyph;
+    uint16_t textWidth = 0;
+
+    for (const char *p = msg; *p && *p != '\n'; p++) {
+        textWidth += ((p == msg ? 0 : font->spacing) + findGlyph(*p, &glyph)) * textScale;
+    }
+
+    return textWidth;
+}
+
+
+/*!
+    @brief  Sets the position used by the Print interface (print(value), println(value), printf-style helpers).
+    @param  x   x coordinate corresponding to top left position of next character
+    @param  y   y coordinate corresponding to top left position of next character
+*/
+void SH1106_OLED::setCursor(uint8_t x, uint8_t y) {
+    cursorX = x;
+    cursorY = y;
+}
+
+
+/*!
+    @brief  Writes a single character at the cursor and advances it. A newline returns the cursor to the left edge of the next line.
+    @param  c   Character to write
+    @returns Number of characters written
+*/
+size_t SH1106_OLED::write(uint8_t c) {
+    if (c == '\n') {
+        if (textRotated) {
+            cursorX -= (font->height + 1) * textScale;
+            cursorY = 0;
+        } else {
+            cursorX = 0;
+            cursorY += (font->height + 1) * textScale;
+        }
+
+        return 1;
+    }
+
+    if (c == '\r') {
+        return 1;
+    }
+
+    uint8_t advance = (drawChar(c, cursorX, cursorY) + font->spacing) * textScale;
+    if (textRotated) {
+        cursorY += advance;
+    } else {
+        cursorX += advance;
+    }
+
+    return 1;
+}
+
+
+/*!
+    @brief  Sets an integer magnification for text. Scaled glyphs are expanded once and kept in a small cache.
+    @param  scale   Magnification factor, e.g. 2 for double size text
+*/
+void SH1106_OLED::setTextScale(uint8_t scale) {
+    textScale = scale ? scale : 1;
+}
+
+
+/*!
+    @brief  Rotates text 90 degrees clockwise, so it reads from top to bottom. Rotated glyphs are kept in the glyph cache.
+    @param  rotated     True for rotated text, false for normal text
+*/
+void SH1106_OLED::setTextRotation(bool rotated) {
+    textRotated = rotated;
+}
+
+
+/*!
+    @brief  Returns the number of scaled or rotated glyphs drawn from the glyph cache.
+    @returns Number of cache hits since initialisation
+*/
+uint32_t SH1106_OLED::getGlyphCacheHits() {
+    return glyphCacheHits;
+}
+
+
+/*!
+    @brief  Returns the number of scaled or rotated glyphs that had to be expanded because they were not in the glyph cache.
+    @returns Number of cache misses since initialisation
+*/
+uint32_t SH1106_OLED::getGlyphCacheMisses() {
+    return glyphCacheMisses;
+}
+
+
+/*!
+    @brief  Draws a bitmap of specified width and height to the screen buffer, clipped to the screen and clip region.
+            Bitmaps are stored as pages of 8 rows, each page a run of bitmapWidth column bytes with the top row in bit 0.
+    @param  bitmap          Pointer to uint8_t specifying beginning address of bitmap array
+    @param  x               x coordinate corresponding to top left position of bitmap start, may be off screen
+    @param  y               y coordinate corresponding to top left position of bitmap start, may be off screen
+    @param  bitmapWidth     Width of bitmap
+    @param  bitmapHeight    Height of bitmap
+    @param  mode            How bitmap pixels combine with the buffer: BITMAP_OR sets, BITMAP_AND clears where the bitmap is clear,
+                            BITMAP_XOR inverts and BITMAP_COPY replaces
+    @param  inProgmem       True if bitmap is in PROGMEM, false if it is in RAM
+*/
+void SH1106_OLED::drawBitmap(const uint8_t *bitmap, int16_t x, int16_t y, uint8_t bitmapWidth, uint8_t bitmapHeight, BitmapMode mode, bool inProgmem) {
+    blit(bitmap, NULL, inProgmem, 1, bitmapWidth, x, y, bitmapWidth, bitmapHeight, mode);
+}
+
+
+/*!
+    @brief  Draws a run-length compressed bitmap from PROGMEM, clipped to the screen and clip region.
+            The bitmap is decoded a byte at a time straight into the buffer, so no temporary storage is needed.
+            Compressed bitmaps are made with extras/bitmap2rle.py. After a width and height byte, the page-packed
+            bitmap data is a sequence of control bytes:
+            0x00-0x7F copy the next (n + 1) bytes, 0x80-0xBF repeat the next byte ((n & 0x3F) + 2) times,
+            0xC0-0xDF write ((n & 0x1F) + 1) 0x00 bytes and 0xE0-0xFF write ((n & 0x1F) + 1) 0xFF bytes.
+    @param  data    PROGMEM address of compressed bitmap
+    @param  x       x coordinate corresponding to top left position of bitmap start, may be off screen
+    @param  y       y coordinate corresponding to top left position of bitmap start, may be off screen
+    @param  mode    How bitmap pixels combine with the buffer
+*/
+void SH1106_OLED::drawCompressedBitmap(const uint8_t *data, int16_t x, int16_t y, BitmapMode mode) {
+    uint8_t w = pgm_read_byte(data);
+    uint8_t h = pgm_read_byte(data + 1);
+    int16_t firstColumn = max(x, (int16_t)clipX1);
+    int16_t lastColumn = min((int16_t)(x + w - 1), (int16_t)clipX2);
+    if (w == 0 || h == 0 || y > clipY2 || y + h <= clipY1 || firstColumn > lastColumn) {
+        return;
+    }
+
+    int16_t page = y >> 3;
+    uint8_t shift = y & 0x07;
+    uint8_t sourcePages = (h + 7) / 8;
+    uint8_t lastValid = (h & 0x07) ? 0xFF >> (8 - (h & 0x07)) : 0xFF;
+    // Runs of clear pixels change nothing when ORing or XORing, so they are skipped rather than written
+    bool skipZeros = (mode == BITMAP_OR || mode == BITMAP_XOR);
+
+    const uint8_t *next = data + 2;
+    uint8_t j = 0;
+    uint8_t column = 0;
+    uint8_t lowMask, highMask;
+    getBlitMasks(page, shift, sourcePages == 1 ? lastValid : 0xFF, lowMask, highMask);
+
+    while (j < sourcePages) {
+        uint8_t control = pgm_read_byte(next++);
+        bool literal = control < 0x80;
+        uint8_t count;
+        uint8_t value = 0;
+        if (literal) {
+            count = control + 1;
+        } else if (control < 0xC0) {
+            count = (control & 0x3F) + 2;
+            value = pgm_read_byte(next++);
+        } else {
+            count = (control & 0x1F) + 1;
+            value = (control & 0x20) ? 0xFF : 0x00;
+        }
+
+        while (count-- && j < sourcePages) {
+            if (literal) {
+                value = pgm_read_byte(next++);
+            }
+
+            int16_t dx = x + column;
+            if (dx >= firstColumn && dx <= lastColumn && (value || !skipZeros)) {
+                int16_t lowIndex = ((page + j) * width) + dx;
+                if (lowMask) {
+                    blendByte(lowIndex, value << shift, lowMask, mode);
+                }
+
+                if (highMask) {
+                    blendByte(lowIndex + width, value >> (8 - shift), highMask, mode);
+                }
+            }
+
+            if (++column == w) {
+                column = 0;
+                j++;
+                getBlitMasks(page + j, shift, j == sourcePages - 1 ? lastValid : 0xFF, lowMask, highMask);
+            }
         }
+    }
+
+    markDirtyRect(firstColumn, max(y, (int16_t)clipY1), lastColumn, min((int16_t)(y + h - 1), (int16_t)clipY2));
+}
+
+
+/*!
+    @brief  Draws a bitmap with a transparency mask, clipped to the screen and clip region.
+            Where the mask is set the bitmap replaces the buffer, elsewhere the buffer is left unchanged.
+    @param  bitmap          Pointer to uint8_t specifying beginning address of bitmap array
+    @param  mask            Pointer to mask array, in the same layout and memory as bitmap
+    @param  x               x coordinate corresponding to top left position of bitmap start, may be off screen
+    @param  y               y coordinate corresponding to top left position of bitmap start, may be off screen
+    @param  bitmapWidth     Width of bitmap
+    @param  bitmapHeight    Height of bitmap
+    @param  inProgmem       True if bitmap and mask are in PROGMEM, false if they are in RAM
+*/
+void SH1106_OLED::drawBitmapMasked(const uint8_t *bitmap, const uint8_t *mask, int16_t x, int16_t y, uint8_t bitmapWidth, uint8_t bitmapHeight, bool inProgmem) {
+    blit(bitmap, mask, inProgmem, 1, bitmapWidth, x, y, bitmapWidth, bitmapHeight, BITMAP_COPY);
+}
+
+
+/*!
+    @brief  Restricts drawing to a rectangle: pixels, lines, shapes, text and bitmaps outside it are left unchanged.
+            clear(), invert() and displayBattery() still cover the whole screen. The rectangle is clamped to the screen.
+    @param  x1  x coordinate of one corner of clip rectangle
+    @param  y1  y coordinate of one corner of clip rectangle
+    @param  x2  x coordinate of opposite corner of clip rectangle
+    @param  y2  y coordinate of opposite corner of clip rectangle
+*/
+void SH1106_OLED::setClipRect(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    if (x2 < x1) {
+        swap(x1, x2);
+    }
+
+    if (y2 < y1) {
+        swap(y1, y2);
+    }
+
+    clipX1 = constrain(x1, 0, width - 1);
+    clipY1 = constrain(y1, 0, height - 1);
+    clipX2 = constrain(x2, 0, width - 1);
+    clipY2 = constrain(y2, 0, height - 1);
+}
+
+
+/*!
+    @brief  Removes the clip rectangle so drawing covers the whole screen.
+*/
+void SH1106_OLED::resetClipRect() {
+    clipX1 = 0;
+    clipY1 = 0;
+    clipX2 = width - 1;
+    clipY2 = height - 1;
+}
+
+
+/*!
+    @brief  Returns the clip rectangle, so code drawing under its own clip rectangle can restore the caller's afterwards.
+    @param  x1  Set to x coordinate of left of clip rectangle
+    @param  y1  Set to y coordinate of top of clip rectangle
+    @param  x2  Set to x coordinate of right of clip rectangle
+    @param  y2  Set to y coordinate of bottom of clip rectangle
+*/
+void SH1106_OLED::getClipRect(int16_t &x1, int16_t &y1, int16_t &x2, int16_t &y2) {
+    x1 = clipX1;
+    y1 = clipY1;
+    x2 = clipX2;
+    y2 = clipY2;
+}
+
+
+/*!
+    @brief  Draws horizontal line from x1 to x2 at vertical position y.
+    @param  x1  Starting x coordinate of line
+    @param  x2  Ending x coordinate of line
+    @param  y   Vertical position of line
+*/
+void SH1106_OLED::drawHLine(uint8_t x1, uint8_t x2, uint8_t y) {
+    clamp(x1, 0, width - 1);
+    clamp(x2, 0, width - 1);
+    clamp(y, 0, height - 1);
+    fillColumnSpan(min(x1, x2), max(x1, x2), y, y);
+}
+
+
+/*!
+    @brief  Draws vertical line from y1 to y2 at horizontal position x.
+    @param  y1  Starting y coordinate of line
+    @param  y2  Ending y coordinate of line
+    @param  x   Horizontal position of line
+*/
+void SH1106_OLED::drawVLine(uint8_t y1, uint8_t y2, uint8_t x) {
+    clamp(y1, 0, height - 1);
+    clamp(y2, 0, height - 1);
+    clamp(x, 0, width - 1);
+    fillColumnSpan(x, x, min(y1, y2), max(y1, y2));
+}
+
+
+/*!
+    @brief  Draws a line from position x1, y1 to position x2, y2.
+    @param  x1  x coordinate of line starting point
+    @param  y1  y coordinate of line starting point
+    @param  x2  x coordinate of line ending point
+    @param  y2  y coordinate of line ending point
+*/
+void SH1106_OLED::drawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
+    rasteriseLine(x1, y1, x2, y2);
+}
+
+
+/*!
+    @brief  Draws a rectange at position x, y with specified width and height.
+    @param  x   Horizontal position of top left corner of rectangle
+    @param  y   Vertical position of top left corner of rectangle
+    @param  w   Width of rectangle in pixels
+    @param  h   Height of rectangle in pixels
+*/
+void SH1106_OLED::drawRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+    outlineRect(*this, x, y, w, h);
+}
+
+
+/*!
+    @brief  Draws a filled rectange at position x, y with specified width and height.
+    @param  x   Horizontal position of top left corner of rectangle
+    @param  y   Vertical position of top left corner of rectangle
+    @param  w   Width of rectangle in pixels
+    @param  h   Height of rectangle in pixels
+*/
+void SH1106_OLED::drawRectFill(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+    fillColumnSpan(x, x + w, y, y + h);
+}
+
+
+/*!
+    @brief  Draws a rectange with rounded corners at position x, y with specified width and height and corner radius.
+    @param  x   Horizontal position of top left corner of rectangle
+    @param  y   Vertical position of top left corner of rectangle
+    @param  w   Width of rectangle in pixels
+    @param  h   Height of rectangle in pixels
+    @param  r   Radius of rounded corners
+*/
+void SH1106_OLED::drawRoundedRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t r) {
+    outlineRoundedRect(*this, x, y, w, h, r);
+}
+
+
+/*!
+    @brief  Draws a filled rectange with rounded corners at position x, y with specified width and height and corner radius.
+    @param  x   Horizontal position of top left corner of rectangle
+    @param  y   Vertical position of top left corner of rectangle
+    @param  w   Width of rectangle in pixels
+    @param  h   Height of rectangle in pixels
+    @param  r   Radius of rounded corners
+*/
+void SH1106_OLED::drawRoundedRectFill(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t r) {
+    r = getClampedRadius(w, h, r);
+
+    fillColumnSpan(x + r + 1, x + w - r - 1, y, y + h);
+    fillRounded(x + r, x + w - r, y + r, y + h - r, r, ALL_CORNERS);
+}
+
+
+/*!
+    @brief  Draws a circle with centre at xCentre, yCentre position, with specified radius.
+            Shoutout to Adafruit for the sick circle algorithm
+    @param  xCentre     Centre x coordinate of circle
+    @param  yCentre     Centre y coordinate of circle
+    @param  radius      Radius of circle
+*/
+void SH1106_OLED::drawCircle(uint8_t xCentre, uint8_t yCentre, uint8_t radius) {
+    outlineCircle(*this, xCentre, yCentre, radius);
+}
+
+
+/*!
+    @brief  Draws a filled circle with centre at xCentre, yCentre position, with specified radius.
+    @param  xCentre     Centre x coordinate of circle
+    @param  yCentre     Centre y coordinate of circle
+    @param  radius      Radius of circle
+*/
+void SH1106_OLED::drawCircleFill(uint8_t xCentre, uint8_t yCentre, uint8_t radius) {
+    fillRounded(xCentre, xCentre, yCentre, yCentre, radius, ALL_CORNERS);
+}
+
+
+/*!
+    @brief  Draws a corner arc with centre at xCentre, yCentre position, with specified radius.
+    @param  xCentre     Centre x coordinate of arc
+    @param  yCentre     Centre y coordinate of arc
+    @param  radius      Radius of arc
+    @param  corner      Corner corresponding to arc orientation
+*/
+void SH1106_OLED::drawArc(uint8_t xCentre, uint8_t yCentre, uint8_t radius, Corner corner) {
+    outlineCorner(*this, xCentre, yCentre, radius, corner);
+}
+
+
+/*!
+    @brief  Draws a filled corner arc with centre at xCentre, yCentre position, with specified radius.
+    @param  xCentre     Centre x coordinate of arc
+    @param  yCentre     Centre y coordinate of arc
+    @param  radius      Radius of arc
+    @param  corner      Corner corresponding to arc orientation
+*/
+void SH1106_OLED::drawArcFill(uint8_t xCentre, uint8_t yCentre, uint8_t radius, Corner corner) {
+    fillRounded(xCentre, xCentre, yCentre, yCentre, radius, 1 << corner);
+}
+
+
+/*!
+    @brief  Draws an arc with centre at xCentre, yCentre position, with specified radius between start and end angles.
+            Angles are in degrees, measured clockwise from the positive x axis, and the arc runs clockwise from start to end.
+            Ranges that wrap past 360 are supported, and an arc from an angle back to the same angle plus 360 is a full circle.
+    @param  xCentre     Centre x coordinate of arc
+    @param  yCentre     Centre y coordinate of arc
+    @param  radius      Radius of arc
+    @param  startAngle  Angle corresponding to start of arc
+    @param  endAngle    Angle corresponding to end of arc
+*/
+void SH1106_OLED::drawArcRaw(uint8_t xCentre, uint8_t yCentre, uint8_t radius, uint16_t startAngle, uint16_t endAngle) {
+    if (startAngle == endAngle) {
+        return;
+    }
+
+    outlineArc(*this, xCentre, yCentre, radius, getArcBounds(startAngle, endAngle));
+}
+
+
+/*!
+    @brief  Draws an arc of specified thickness, extending inwards from the outer radius, between start and end angles.
+            Angles follow the same convention as drawArcRaw().
+    @param  xCentre     Centre x coordinate of arc
+    @param  yCentre     Centre y coordinate of arc
+    @param  radius      Outer radius of arc
+    @param  thickness   Width of arc in pixels
+    @param  startAngle  Angle corresponding to start of arc
+    @param  endAngle    Angle corresponding to end of arc
+*/
+void SH1106_OLED::drawArcThick(uint8_t xCentre, uint8_t yCentre, uint8_t radius, uint8_t thickness, uint16_t startAngle, uint16_t endAngle) {
+    if (startAngle == endAngle || thickness == 0) {
+        return;
+    }
+
+    uint8_t innerRadius = thickness > radius ? 0 : radius - thickness + 1;
+    fillArcRing(xCentre, yCentre, radius, innerRadius, getArcBounds(startAngle, endAngle));
+}
+
+
+/*!
+    @brief  Draws a filled pie slice with centre at xCentre, yCentre position between start and end angles.
+            Angles follow the same convention as drawArcRaw().
+    @param  xCentre     Centre x coordinate of slice
+    @param  yCentre     Centre y coordinate of slice
+    @param  radius      Radius of slice
+    @param  startAngle  Angle corresponding to start of slice
+    @param  endAngle    Angle corresponding to end of slice
+*/
+void SH1106_OLED::drawPie(uint8_t xCentre, uint8_t yCentre, uint8_t radius, uint16_t startAngle, uint16_t endAngle) {
+    if (startAngle == endAngle) {
+        return;
+    }
+
+    fillArcRing(xCentre, yCentre, radius, 0, getArcBounds(startAngle, endAngle));
+}
+
+
+/*!
+    @brief  Draws triangle specified by x, y positions of corners
+    @param  x1  x coordinate of first corner
+    @param  y1  y coordinate of first corner
+    @param  x2  x coordinate of second corner
+    @param  x2  x coordinate of second corner
+    @param  y3  y coordinate of third corner
+    @param  y3  y coordinate of third corner
+*/
+void SH1106_OLED::drawTriangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t x3, uint8_t y3) {
+    drawLine(x1, y1, x2, y2);
+    drawLine(x2, y2, x3, y3);
+    drawLine(x3, y3, x1, y1);
+}
+
+
+/*!
+    @brief  Draws filled triangle specified by x, y positions of corners
+    @param  x1  x coordinate of first corner
+    @param  y1  y coordinate of first corner
+    @param  x2  x coordinate of second corner
+    @param  x2  x coordinate of second corner
+    @param  y3  y coordinate of third corner
+    @param  y3  y coordinate of third corner
+*/
+void SH1106_OLED::drawTriangleFill(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t x3, uint8_t y3) {
+    fillTriangle(*this, x1, y1, x2, y2, x3, y3);
+}
+
+
+/*!
+    @brief  Draws battery icon with variable charge level to top right corner of screen.
+    @param  percentage  Percentage charge of battery (0-100)
+*/
+void SH1106_OLED::displayBattery(uint8_t percentage) {
+    uint8_t batteryWidth = 12;
+    uint8_t batteryBitmap[batteryWidth];
+
+    for (int i = 0; i < batteryWidth; i++) {
+        batteryBitmap[i] = pgm_read_byte(batteryCase + i);
+    }
+
+    if (percentage > 5) {
+        batteryBitmap[2] |= pgm_read_byte(batteryLowCell);
+        batteryBitmap[3] |= pgm_read_byte(batteryLowCell + 1);
+    }
+
+    if (percentage > 35) {
+        batteryBitmap[5] |= batteryMidCell;
+    }
+
+    if (percentage > 70) {
+        batteryBitmap[7] |= pgm_read_byte(batteryHighCell);
+        batteryBitmap[8] |= pgm_read_byte(batteryHighCell + 1);
+    }
+
+    int bufferIndex = width - batteryWidth;
+    for (int i = 0; i < batteryWidth; i++) {
+        buffer[bufferIndex + i] = batteryBitmap[i];
+    }
+
+    markDirty(bufferIndex, width - 1, 0);
+}
+
+
+/*!
+    @brief  Returns the running count of buffer bytes that display() did not need to send because they were unchanged.
+    @returns Number of bytes saved since initialisation
+*/
+uint32_t SH1106_OLED::getBytesSaved() {
+    return bytesSaved;
+}
+
+
+/*!
+    @brief  Returns the running count of bytes written to the bus, including control and command bytes.
+            On I2C, together with getTransactionCount() this gives the bus time spent, as each byte takes 9 clock cycles
+            and each transaction adds an address byte plus start and stop conditions.
+    @returns Number of bytes sent since initialisation
+*/
+uint32_t SH1106_OLED::getBytesSent() {
+    return transport->getBytesSent();
+}
+
+
+/*!
+    @brief  Returns the running count of bus transactions sent to the SH1106.
+    @returns Number of transactions since initialisation
+*/
+uint32_t SH1106_OLED::getTransactionCount() {
+    return transport->getTransactionCount();
+}
+
+
+/*!
+    @brief  Returns the width of the display.
+    @returns Width of display in pixels
+*/
+uint8_t SH1106_OLED::getWidth() {
+    return width;
+}
+
+
+/*!
+    @brief  Returns the height of the display.
+    @returns Height of display in pixels
+*/
+uint8_t SH1106_OLED::getHeight() {
+    return height;
+}
+
+
+/*!
+    @brief  Returns the screen buffer being drawn to, laid out as pages of 8 rows with one byte per column.
+            With double buffering the returned buffer changes after each display().
+    @returns Pointer to screen buffer, valid after init()
+*/
+uint8_t *SH1106_OLED::getBuffer() {
+    return buffer;
+}
+
+
+/*!
+    @brief  Returns the size of the screen buffer.
+    @returns Size of screen buffer in bytes
+*/
+uint16_t SH1106_OLED::getBufferSize() {
+    return bufferSize;
+}
+
+
+/*!
+    @brief  Uses caller-provided storage of getBufferSize() bytes as the screen buffer instead of allocating it in init(),
+            for example so several displays can share one allocation. Must be called before init().
+    @param  storage     Storage for screen buffer, which must outlive the display
+    @returns Boolean true if the storage was accepted, false if a buffer is already in use
+*/
+bool SH1106_OLED::setBuffer(uint8_t *storage) {
+    if (buffer) {
+        return false;
+    }
+
+    buffer = storage;
+    return true;
+}
+
+
+/*!
+    @brief  Returns how many bytes the next display() would send for changes drawn since the last one, before double buffering.
+    @returns Number of dirty buffer bytes
+*/
+uint16_t SH1106_OLED::getDirtyBytes() {
+    uint16_t dirtyBytes = 0;
+    for (uint8_t page = 0; page < pages; page++) {
+        if (dirtyStart[page] <= dirtyEnd[page]) {
+            dirtyBytes += dirtyEnd[page] - dirtyStart[page] + 1;
+        }
+    }
+
+    return dirtyBytes;
+}
+
+
+/*!
+    @brief  Returns whether settings such as the start line or contrast are waiting to be sent with the next transfer,
+            so a display() is needed even when nothing has been drawn.
+    @returns Boolean true if settings are pending
+*/
+bool SH1106_OLED::hasPendingSettings() {
+    return pendingSettings != 0;
+}
+
+
+/*!
+    @brief  Returns the transport the display sends through.
+    @returns Transport to the SH1106
+*/
+SH1106_Transport &SH1106_OLED::getTransport() {
+    return *transport;
+}
+
+
+/*!
+    @brief  Sends everything through a different transport from now on, for example one wrapping the current transport.
+            Completes any transfer in progress first.
+    @param  newTransport    Transport to the SH1106, which must outlive the display
+*/
+void SH1106_OLED::setTransport(SH1106_Transport &newTransport) {
+    while (pollDisplay());
+    transport = &newTransport;
+}
+
+
+/*!
+    @brief  Sends single command to SH1106 OLED screen.
+    @param  command     Byte value for command according to SH1106 datasheet
+*/
+void SH1106_OLED::sendCommand(uint8_t command) {
+    while (transport->isBusy());
+    transport->sendCommands(&command, 1);
+}
+
+
+/*!
+    @brief  Sends a command followed by its argument byte to SH1106 OLED screen.
+    @param  command     Byte value for command according to SH1106 datasheet
+    @param  data        Data value for specified command
+*/
+void SH1106_OLED::sendDualCommand(uint8_t command, uint8_t data) {
+    uint8_t commands[2] = { command, data };
+    while (transport->isBusy());
+    transport->sendCommands(commands, 2);
+}
+
+
+/*!
+    @brief  Sends a sequence of commands to SH1106 OLED screen in a single transaction.
+    @param  commands    Commands according to SH1106 datasheet
+*/
+void SH1106_OLED::sendCommands(const SH1106_CommandStream &commands) {
+    if (commands.getLength() == 0) {
+        return;
+    }
+
+    while (transport->isBusy());
+    transport->sendCommands(commands.getCommands(), commands.getLength());
+}
+
+
+/*!
+    @brief  Waits until the charge pump has been on for SH1106_CHARGE_PUMP_DELAY, as required before turning the display on.
+*/
+void SH1106_OLED::waitForChargePump() {
+    uint32_t elapsed = millis() - chargePumpStart;
+    if (elapsed < SH1106_CHARGE_PUMP_DELAY) {
+        delay(SH1106_CHARGE_PUMP_DELAY - elapsed);
+    }
+}
+
+
+
+/*!
+    @brief  Records columns x1 to x2 of the specified page as modified so display() sends them.
+    @param  x1      First modified column
+    @param  x2      Last modified column
+    @param  page    Page (group of 8 rows) containing the modified columns
+*/
+void SH1106_OLED::markDirty(uint8_t x1, uint8_t x2, uint8_t page) {
+    if (page >= pages) {
+        return;
+    }
+
+    if (x2 >= width) {
+        x2 = width - 1;
+    }
+
+    if (x1 > x2) {
+        return;
+    }
+
+    if (x1 < dirtyStart[page]) {
+        dirtyStart[page] = x1;
+    }
+
+    if (x2 > dirtyEnd[page]) {
+        dirtyEnd[page] = x2;
+    }
+}
+
+
+/*!
+    @brief  Records a rectangular region of the screen buffer as modified.
+    @param  x1  Left column of region
+    @param  y1  Top row of region
+    @param  x2  Right column of region
+    @param  y2  Bottom row of region
+*/
+void SH1106_OLED::markDirtyRect(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
+    for (uint8_t page = y1 / 8; page <= y2 / 8 && page < pages; page++) {
+        markDirty(x1, x2, page);
+    }
+}
+
+
+/*!
+    @brief  Records the entire screen buffer as modified.
+*/
+void SH1106_OLED::markAllDirty() {
+    for (uint8_t page = 0; page < MAX_PAGES; page++) {
+        dirtyStart[page] = 0;
+        dirtyEnd[page] = width - 1;
+    }
+}
+
+
+/*!
+    @brief  Clears a band of buffer rows, wrapping from the bottom of the buffer to the top.
+    @param  y       First row to clear
+    @param  count   Number of rows to clear
+*/
+void SH1106_OLED::clearRows(uint8_t y, uint8_t count) {
+    uint8_t masks[MAX_PAGES] = { 0 };
+    for (uint8_t i = 0; i < count && i < height; i++) {
+        uint8_t row = (y + i) % height;
+        masks[row / 8] |= 0x01 << (row & 0x07);
+    }
+
+    for (uint8_t page = 0; page < pages; page++) {
+        if (!masks[page]) {
+            continue;
+        }
+
+        uint8_t *pageData = buffer + (page * width);
+        for (uint8_t x = 0; x < width; x++) {
+            pageData[x] &= ~masks[page];
+        }
+
+        markDirty(0, width - 1, page);
+    }
+}
+
+
+/*!
+    @brief  Sends the settings changed since the last transfer, such as the start line set with setStartLine() or scroll(),
+            together in one command stream. Called once the frame data has been sent, so the new settings and the new frame
+            appear together.
+*/
+void SH1106_OLED::sendPendingSettings() {
+    if (!pendingSettings) {
+        return;
+    }
+
+    SH1106_CommandStream commands;
+    if (pendingSettings & PENDING_START_LINE) {
+        commands.add(0x40 | ((flushStartLine + flushRamRowOffset) % SH1106_RAM_ROWS)); // Set display start line
+    }
+
+    if (pendingSettings & PENDING_CONTRAST) {
+        commands.add(0x81, contrast); // Set contrast
+    }
+
+    if (pendingSettings & PENDING_INVERSE) {
+        commands.add(inverse ? 0xA7 : 0xA6); // Set normal/inverse display
+    }
+
+    if (pendingSettings & PENDING_ORIENTATION) {
+        bool flipped = orientation == ORIENTATION_FLIPPED;
+        commands.add(flipped ? 0xA0 : 0xA1); // Set segment re-map
+        commands.add(flipped ? 0xC0 : 0xC8); // Set COM output scan direction
+    }
+
+    sendCommands(commands);
+    // A start line set during the transfer goes out with the pages it moved, in the next transfer
+    pendingSettings = (startLine != flushStartLine || ramRowOffset != flushRamRowOffset) ? PENDING_START_LINE : 0;
+}
+
+
+/*!
+    @brief  Advances the transfer to the next page with data to send, starting from the current page.
+*/
+void SH1106_OLED::seekFlushPage() {
+    while (flushPage < pages && flushStart[flushPage] > flushEnd[flushPage]) {
+        flushPage++;
+    }
+
+    if (flushPage < pages) {
+        flushColumn = flushStart[flushPage];
+        flushRamPages = getRamPages(flushPage, flushStartLine, flushRamRowOffset);
+    }
+}
+
+
+/*!
+    @brief  Returns the RAM pages a buffer page has to be sent to for a start line. Rows from the start line down
+            go to RAM page (page + offset) and rows above it to the RAM page one panel height further on, so a page
+            the start line falls inside goes to two RAM pages unless the panel is 64 rows high.
+    @param  page            Buffer page
+    @param  line            Display start line
+    @param  rowOffset       RAM row of buffer row 0
+    @returns Bit mask of RAM pages
+*/
+uint8_t SH1106_OLED::getRamPages(uint8_t page, uint8_t line, uint8_t rowOffset) {
+    uint8_t ramPage = (page + (rowOffset / 8)) % MAX_PAGES;
+    uint8_t ramPages = 0;
+    if ((page * 8) + 7 >= line) {
+        ramPages |= 0x01 << ramPage;
+    }
 
-        x++;
-        ddF_x += 2;
-        f += ddF_x;
+    if (page * 8 < line) {
+        ramPages |= 0x01 << ((ramPage + pages) % MAX_PAGES);
+    }
+
+    return ramPages;
+}
+
+
+/*!
+    @brief  Narrows the transfer span of a page to the columns that differ between the front and drawing buffers.
+            Only the dirty span is compared, as nothing outside it can have changed.
+    @param  page    Page to compare
+*/
+void SH1106_OLED::findChangedSpan(uint8_t page) {
+    uint8_t *front = frontBuffer + (page * width);
+    uint8_t *back = buffer + (page * width);
+
+    uint8_t start = flushStart[page];
+    uint8_t end = flushEnd[page];
+    while (start <= end && front[start] == back[start]) {
+        start++;
+    }
+
+    if (start > end) {
+        flushStart[page] = 0xFF;
+        flushEnd[page] = 0;
+        return;
+    }
 
-        setPixel(xCentre + x, yCentre + y);
-        setPixel(xCentre - x, yCentre + y);
-        setPixel(xCentre + x, yCentre - y);
-        setPixel(xCentre - x, yCentre - y);
-        setPixel(xCentre + y, yCentre + x);
-        setPixel(xCentre - y, yCentre + x);
-        setPixel(xCentre + y, yCentre - x);
-        setPixel(xCentre - y, yCentre - x);
+    while (front[end] == back[end]) {
+        end--;
     }
+
+    flushStart[page] = start;
+    flushEnd[page] = end;
 }
 
 
 /*!
-    @brief  Draws a filled circle with centre at xCentre, yCentre position, with specified radius.
-    @param  xCentre     Centre x coordinate of circle
-    @param  yCentre     Centre y coordinate of circle
-    @param  radius      Radius of circle
+    @brief  Fills columns x1 to x2 between rows y1 and y2, clipped to the clip rectangle.
+            Each buffer byte is written once, using a partial mask for the top and bottom pages and 0xFF in between.
+    @param  x1  First column of span
+    @param  x2  Last column of span
+    @param  y1  Top row of span
+    @param  y2  Bottom row of span
 */
-void SH1106_OLED::drawCircleFill(uint8_t xCentre, uint8_t yCentre, uint8_t radius) {
-    int16_t f = 1 - radius;
-    int16_t ddF_x = 1;
-    int16_t ddF_y = -2 * radius;
-    int16_t x = 0;
-    int16_t y = radius;
+void SH1106_OLED::fillColumnSpan(int16_t x1, int16_t x2, int16_t y1, int16_t y2) {
+    if (x1 < clipX1) x1 = clipX1;
+    if (y1 < clipY1) y1 = clipY1;
+    if (x2 > clipX2) x2 = clipX2;
+    if (y2 > clipY2) y2 = clipY2;
 
-    drawHLine(xCentre - radius, xCentre + radius, yCentre);
+    if (x1 > x2 || y1 > y2) {
+        return;
+    }
 
-    while (x < y) {
-        if (f >= 0) {
-            y--;
-            ddF_y += 2;
-            f += ddF_y;
+    uint8_t firstPage = y1 / 8;
+    uint8_t lastPage = y2 / 8;
+    uint8_t topMask = 0xFF << (y1 & 0x07);
+    uint8_t bottomMask = 0xFF >> (7 - (y2 & 0x07));
+    if (firstPage == lastPage) {
+        topMask &= bottomMask;
+    }
+
+    uint8_t *row = buffer + (firstPage * width);
+    for (int16_t x = x1; x <= x2; x++) {
+        row[x] |= topMask;
+    }
+
+    for (uint8_t page = firstPage + 1; page < lastPage; page++) {
+        memset(buffer + (page * width) + x1, 0xFF, x2 - x1 + 1);
+    }
+
+    if (lastPage > firstPage) {
+        row = buffer + (lastPage * width);
+        for (int16_t x = x1; x <= x2; x++) {
+            row[x] |= bottomMask;
         }
+    }
 
-        x++;
-        ddF_x += 2;
-        f += ddF_x;
+    markDirtyRect(x1, y1, x2, y2);
+}
+
+
+/*!
+    @brief  Fills the column pair offset either side of a rounded shape's straight section, for the selected corners.
+    @param  xLeft       Column of the left corner centres
+    @param  xRight      Column of the right corner centres
+    @param  yTop        Row of the top corner centres
+    @param  yBottom     Row of the bottom corner centres
+    @param  offset      Horizontal distance of the columns from the corner centres
+    @param  extent      Vertical distance the columns reach beyond the corner centres
+    @param  corners     Bitmask of corners to fill, with bit n set for Corner n
+*/
+void SH1106_OLED::fillRoundedColumns(int16_t xLeft, int16_t xRight, int16_t yTop, int16_t yBottom, int16_t offset, int16_t extent, uint8_t corners) {
+    uint8_t left = corners & ((1 << TOP_LEFT) | (1 << BOTTOM_LEFT));
+    uint8_t right = corners & ((1 << TOP_RIGHT) | (1 << BOTTOM_RIGHT));
+
+    if (offset == 0 && xLeft == xRight) {
+        // Both sides share the centre column, so fill it once
+        left |= right;
+        right = 0;
+    }
+
+    if (left) {
+        fillColumnSpan(xLeft - offset, xLeft - offset,
+                       (left & ((1 << TOP_LEFT) | (1 << TOP_RIGHT))) ? yTop - extent : yTop,
+                       (left & ((1 << BOTTOM_LEFT) | (1 << BOTTOM_RIGHT))) ? yBottom + extent : yBottom);
+    }
 
-        drawHLine(xCentre - x, xCentre + x, yCentre + y);
-        drawHLine(xCentre - x, xCentre + x, yCentre - y);
-        drawHLine(xCentre - y, xCentre + y, yCentre + x);
-        drawHLine(xCentre - y, xCentre + y, yCentre - x);
+    if (right) {
+        fillColumnSpan(xRight + offset, xRight + offset,
+                       (right & (1 << TOP_RIGHT)) ? yTop - extent : yTop,
+                       (right & (1 << BOTTOM_RIGHT)) ? yBottom + extent : yBottom);
     }
 }
 
 
 /*!
-    @brief  Draws a corner arc with centre at xCentre, yCentre position, with specified radius.
-    @param  xCentre     Centre x coordinate of arc
-    @param  yCentre     Centre y coordinate of arc
-    @param  radius      Radius of arc
-    @param  corner      Corner corresponding to arc orientation
+    @brief  Fills the rounded corners of a shape as vertical column spans, writing each column once.
+            A circle is the case where all corner centres coincide.
+    @param  xLeft       Column of the left corner centres
+    @param  xRight      Column of the right corner centres
+    @param  yTop        Row of the top corner centres
+    @param  yBottom     Row of the bottom corner centres
+    @param  radius      Radius of corners
+    @param  corners     Bitmask of corners to fill, with bit n set for Corner n
 */
-void SH1106_OLED::drawArc(uint8_t xCentre, uint8_t yCentre, uint8_t radius, Corner corner) {
+void SH1106_OLED::fillRounded(int16_t xLeft, int16_t xRight, int16_t yTop, int16_t yBottom, uint8_t radius, uint8_t corners) {
     int16_t f = 1 - radius;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * radius;
     int16_t x = 0;
     int16_t y = radius;
 
-    if (corner == BOTTOM_LEFT || corner == BOTTOM_RIGHT) setPixel(xCentre, yCentre + radius);
-    if (corner == TOP_LEFT || corner == TOP_RIGHT) setPixel(xCentre, yCentre - radius);
-    if (corner == TOP_RIGHT || corner == BOTTOM_RIGHT) setPixel(xCentre + radius, yCentre);
-    if (corner == TOP_LEFT || corner == BOTTOM_LEFT) setPixel(xCentre - radius, yCentre);
+    fillRoundedColumns(xLeft, xRight, yTop, yBottom, 0, radius, corners);
 
     while (x < y) {
         if (f >= 0) {
+            // Column y reaches furthest at the last x before y steps inwards
+            fillRoundedColumns(xLeft, xRight, yTop, yBottom, y, x, corners);
             y--;
             ddF_y += 2;
             f += ddF_y;
@@ -524,261 +1742,590 @@ void SH1106_OLED::drawArc(uint8_t xCentre, uint8_t yCentre, uint8_t radius, Corn
         ddF_x += 2;
         f += ddF_x;
 
-        if (corner == TOP_LEFT) {
-            setPixel(xCentre - y, yCentre - x);
-            setPixel(xCentre - x, yCentre - y);
-        }
+        fillRoundedColumns(xLeft, xRight, yTop, yBottom, x, y, corners);
+    }
 
-        if (corner == TOP_RIGHT) {
-            setPixel(xCentre + x, yCentre - y);
-            setPixel(xCentre + y, yCentre - x);
-        }
+    if (y != x) {
+        fillRoundedColumns(xLeft, xRight, yTop, yBottom, y, x, corners);
+    }
+}
 
-        if (corner == BOTTOM_RIGHT) {
-            setPixel(xCentre + x, yCentre + y);
-            setPixel(xCentre + y, yCentre + x);
-        }
 
-        if (corner == BOTTOM_LEFT) {
-            setPixel(xCentre - y, yCentre + x);
-            setPixel(xCentre - x, yCentre + y);
-        }
+/*!
+    @brief  Finds which steps of a Bresenham walk land in the clip rectangle, so a clipped line lights exactly the pixels
+            the unclipped line would. The walk advances one pixel along the major axis per step, and after i steps has moved
+            getLineOffset(i) pixels along the minor axis.
+    @param  majorStart      Major axis coordinate of the first pixel
+    @param  majorStep       Direction of the walk along the major axis, 1 or -1
+    @param  majorLow        Lowest major axis coordinate inside the clip rectangle
+    @param  majorHigh       Highest major axis coordinate inside the clip rectangle
+    @param  minorStart      Minor axis coordinate of the first pixel
+    @param  minorStep       Direction of the walk along the minor axis, 1 or -1
+    @param  minorLow        Lowest minor axis coordinate inside the clip rectangle
+    @param  minorHigh       Highest minor axis coordinate inside the clip rectangle
+    @param  majorDistance   Length of the line along the major axis
+    @param  minorDistance   Length of the line along the minor axis, at most majorDistance
+    @param  first           Set to the first step inside the clip rectangle
+    @param  last            Set to the last step inside the clip rectangle
+    @returns Boolean true if any part of the line is inside the clip rectangle
+*/
+bool SH1106_OLED::getLineSteps(int16_t majorStart, int8_t majorStep, int16_t majorLow, int16_t majorHigh, int16_t minorStart, int8_t minorStep,
+                               int16_t minorLow, int16_t minorHigh, int16_t majorDistance, int16_t minorDistance, int16_t &first, int16_t &last) {
+    // Steps whose major axis coordinate is inside the clip rectangle
+    first = max((int16_t)0, (int16_t)(majorStep > 0 ? majorLow - majorStart : majorStart - majorHigh));
+    last = min(majorDistance, (int16_t)(majorStep > 0 ? majorHigh - majorStart : majorStart - majorLow));
+
+    // Minor axis offsets that are inside the clip rectangle, narrowed to the steps that reach them
+    int32_t lowOffset = minorStep > 0 ? minorLow - minorStart : minorStart - minorHigh;
+    int32_t highOffset = minorStep > 0 ? minorHigh - minorStart : minorStart - minorLow;
+    if (highOffset < 0 || lowOffset > minorDistance) {
+        return false;
+    }
+
+    int32_t halfMajor = majorDistance / 2;
+    if (lowOffset > 0) {
+        first = max(first, (int16_t)(((lowOffset - 1) * majorDistance + halfMajor) / minorDistance + 1));
+    }
+
+    if (highOffset < minorDistance) {
+        last = min(last, (int16_t)((highOffset * majorDistance + halfMajor) / minorDistance));
     }
+
+    return first <= last;
 }
 
 
 /*!
-    @brief  Draws a filled corner arc with centre at xCentre, yCentre position, with specified radius.
-    @param  xCentre     Centre x coordinate of arc
-    @param  yCentre     Centre y coordinate of arc
-    @param  radius      Radius of arc
-    @param  corner      Corner corresponding to arc orientation
+    @brief  Returns how far a Bresenham walk has moved along its minor axis after a number of steps.
+            The walk starts with its error term at half the major distance, so this is
+            ceil((step * minorDistance - majorDistance / 2) / majorDistance), and never negative.
+    @param  step            Steps taken
+    @param  majorDistance   Length of the line along the major axis
+    @param  minorDistance   Length of the line along the minor axis
+    @returns Minor axis offset from the first pixel
 */
-void SH1106_OLED::drawArcFill(uint8_t xCentre, uint8_t yCentre, uint8_t radius, Corner corner) {
-    int16_t f = 1 - radius;
-    int16_t ddF_x = 1;
-    int16_t ddF_y = -2 * radius;
-    int16_t x = 0;
-    int16_t y = radius;
+int16_t SH1106_OLED::getLineOffset(int16_t step, int16_t majorDistance, int16_t minorDistance) {
+    if (minorDistance == 0) {
+        return 0;
+    }
 
-    if (corner == BOTTOM_LEFT || corner == BOTTOM_RIGHT) drawVLine(yCentre, yCentre + radius, xCentre);
-    if (corner == TOP_LEFT || corner == TOP_RIGHT) drawVLine(yCentre - radius, yCentre, xCentre);
-    if (corner == TOP_RIGHT || corner == BOTTOM_RIGHT) drawHLine(xCentre, xCentre + radius, yCentre);
-    if (corner == TOP_LEFT || corner == BOTTOM_LEFT) drawHLine(xCentre, xCentre - radius, yCentre);
+    return ((int32_t)step * minorDistance - (majorDistance / 2) + majorDistance - 1) / majorDistance;
+}
 
-    while (x < y) {
-        if (f >= 0) {
-            y--;
-            ddF_y += 2;
-            f += ddF_y;
+
+/*!
+    @brief  Draws a clipped line using integer Bresenham stepping, writing straight into the buffer with a running bit mask.
+            Clipping skips the walk ahead to the first step in the clip rectangle rather than moving the end points, so the
+            pixels drawn are exactly those of the unclipped line that fall inside it.
+    @param  x1  x coordinate of line starting point
+    @param  y1  y coordinate of line starting point
+    @param  x2  x coordinate of line ending point
+    @param  y2  y coordinate of line ending point
+*/
+void SH1106_OLED::rasteriseLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    int16_t xDistance = abs(x2 - x1);
+    int16_t yDistance = abs(y2 - y1);
+    int8_t xStep = x2 >= x1 ? 1 : -1;
+    int8_t yStep = y2 >= y1 ? 1 : -1;
+    bool xMajor = xDistance >= yDistance;
+
+    int16_t first;
+    int16_t last;
+    int16_t startX;
+    int16_t startY;
+    int16_t endX;
+    int16_t endY;
+    int16_t error;
+    if (xMajor) {
+        if (!getLineSteps(x1, xStep, clipX1, clipX2, y1, yStep, clipY1, clipY2, xDistance, yDistance, first, last)) {
+            return;
         }
 
-        x++;
-        ddF_x += 2;
-        f += ddF_x;
+        int16_t offset = getLineOffset(first, xDistance, yDistance);
+        startX = x1 + first * xStep;
+        startY = y1 + offset * yStep;
+        endX = x1 + last * xStep;
+        endY = y1 + getLineOffset(last, xDistance, yDistance) * yStep;
+        error = xDistance / 2 - (int32_t)first * yDistance + (int32_t)offset * xDistance;
+    } else {
+        if (!getLineSteps(y1, yStep, clipY1, clipY2, x1, xStep, clipX1, clipX2, yDistance, xDistance, first, last)) {
+            return;
+        }
+
+        int16_t offset = getLineOffset(first, yDistance, xDistance);
+        startX = x1 + offset * xStep;
+        startY = y1 + first * yStep;
+        endX = x1 + getLineOffset(last, yDistance, xDistance) * xStep;
+        endY = y1 + last * yStep;
+        error = yDistance / 2 - (int32_t)first * xDistance + (int32_t)offset * yDistance;
+    }
+
+    if (yDistance == 0) {
+        drawHLine(startX, endX, startY);
+        return;
+    }
 
-        if (corner == TOP_LEFT) {
-            drawHLine(xCentre, xCentre - x, yCentre - y);
-            drawHLine(xCentre, xCentre - y, yCentre - x);
+    if (xDistance == 0) {
+        drawVLine(startY, endY, startX);
+        return;
+    }
+
+    bool down = yStep > 0;
+    uint8_t *ptr = buffer + startX + ((startY / 8) * width);
+    uint8_t mask = 0x01 << (startY & 0x07);
+
+    if (xMajor) {
+        for (int16_t i = first; i <= last; i++) {
+            *ptr |= mask;
+            ptr += xStep;
+            error -= yDistance;
+            if (error < 0) {
+                error += xDistance;
+                if (down) {
+                    mask <<= 1;
+                    if (!mask) {
+                        mask = 0x01;
+                        ptr += width;
+                    }
+                } else {
+                    mask >>= 1;
+                    if (!mask) {
+                        mask = 0x80;
+                        ptr -= width;
+                    }
+                }
+            }
         }
+    } else {
+        for (int16_t i = first; i <= last; i++) {
+            *ptr |= mask;
+            if (down) {
+                mask <<= 1;
+                if (!mask) {
+                    mask = 0x01;
+                    ptr += width;
+                }
+            } else {
+                mask >>= 1;
+                if (!mask) {
+                    mask = 0x80;
+                    ptr -= width;
+                }
+            }
+            error -= xDistance;
+            if (error < 0) {
+                error += yDistance;
+                ptr += xStep;
+            }
+        }
+    }
+
+    markDirtyRect(min(startX, endX), min(startY, endY), max(startX, endX), max(startY, endY));
+}
+
 
-        if (corner == TOP_RIGHT) {
-            drawHLine(xCentre, xCentre + x, yCentre - y);
-            drawHLine(xCentre, xCentre + y, yCentre - x);
+/*!
+    @brief  Fills the pixels between two radii that fall inside an angular range, one row span at a time.
+    @param  xCentre         Centre x coordinate of ring
+    @param  yCentre         Centre y coordinate of ring
+    @param  outerRadius     Outer radius of ring
+    @param  innerRadius     Inner radius of ring, or 0 for a solid disc
+    @param  arc             Angular range to fill
+*/
+void SH1106_OLED::fillArcRing(int16_t xCentre, int16_t yCentre, uint8_t outerRadius, uint8_t innerRadius, const ArcBounds &arc) {
+    // Pixels are inside a radius r when x^2 + y^2 <= r^2 + r, matching the midpoint circle edge
+    int32_t outerLimit = (int32_t)outerRadius * outerRadius + outerRadius;
+    int32_t innerLimit = innerRadius ? (int32_t)innerRadius * innerRadius - innerRadius + 1 : 0;
+    int16_t xOuter = outerRadius;
+    int16_t xInner = innerRadius;
+
+    for (int16_t dy = 0; dy <= outerRadius; dy++) {
+        int32_t dySquared = (int32_t)dy * dy;
+        while ((int32_t)xOuter * xOuter > outerLimit - dySquared) {
+            xOuter--;
         }
 
-        if (corner == BOTTOM_RIGHT) {
-            drawHLine(xCentre, xCentre + x, yCentre + y);
-            drawHLine(xCentre, xCentre + y, yCentre + x);
+        while (xInner > 0 && (int32_t)(xInner - 1) * (xInner - 1) >= innerLimit - dySquared) {
+            xInner--;
         }
 
-        if (corner == BOTTOM_LEFT) {
-            drawHLine(xCentre, xCentre - y, yCentre + x);
-            drawHLine(xCentre, xCentre - x, yCentre + y);
+        for (int8_t side = 1; side >= -1; side -= 2) {
+            if (side < 0 && dy == 0) {
+                break;
+            }
+
+            if (xInner == 0) {
+                fillArcRow(xCentre, yCentre + side * dy, side * dy, -xOuter, xOuter, arc);
+            } else {
+                fillArcRow(xCentre, yCentre + side * dy, side * dy, -xOuter, -xInner, arc);
+                fillArcRow(xCentre, yCentre + side * dy, side * dy, xInner, xOuter, arc);
+            }
         }
     }
 }
 
 
 /*!
-    @brief  Draws an arc with centre at xCentre, yCentre position, with specified radius between start and end angles. *Unoptimised*
+    @brief  Sets the pixels of one row span that fall inside an angular range, updating the cross products incrementally.
     @param  xCentre     Centre x coordinate of arc
-    @param  yCentre     Centre y coordinate of arc
-    @param  radius      Radius of arc
-    @param  startAngle  Angle corresponding to start of arc
-    @param  endAngle    Angle corresponding to end of arc
+    @param  y           Row to fill
+    @param  dy          Vertical offset of row from the arc centre
+    @param  dxStart     Horizontal offset from centre of first pixel in span
+    @param  dxEnd       Horizontal offset from centre of last pixel in span
+    @param  arc         Angular range to fill
 */
-void SH1106_OLED::drawArcRaw(uint8_t xCentre, uint8_t yCentre, uint8_t radius, uint16_t startAngle, uint16_t endAngle) {
-    uint8_t prevX = xCentre;
-    uint8_t prevY = yCentre;
-    float angleIncrement = 180 / (radius * PI);
+void SH1106_OLED::fillArcRow(int16_t xCentre, int16_t y, int16_t dy, int16_t dxStart, int16_t dxEnd, const ArcBounds &arc) {
+    if (y < clipY1 || y > clipY2) {
+        return;
+    }
+
+    if (xCentre + dxStart < clipX1) {
+        dxStart = clipX1 - xCentre;
+    }
+
+    if (xCentre + dxEnd > clipX2) {
+        dxEnd = clipX2 - xCentre;
+    }
 
-    float angle = startAngle + angleIncrement;
-    while (angle < endAngle) { // lets assume for now startAngle < endAngle
-        uint8_t x = radius * getCosineAngle(angle);
-        uint8_t y = radius * getSineAngle(angle);
+    if (dxStart > dxEnd) {
+        return;
+    }
 
-        if (x != prevX || y != prevY) {
-            setPixel(x + xCentre, y + yCentre);
+    uint8_t mask = 0x01 << (y & 0x07);
+    uint8_t *row = buffer + ((y / 8) * width) + xCentre;
+    int32_t fromStart = (int32_t)arc.startX * dy - (int32_t)arc.startY * dxStart;
+    int32_t toEnd = (int32_t)dxStart * arc.endY - (int32_t)dy * arc.endX;
+
+    for (int16_t dx = dxStart; dx <= dxEnd; dx++) {
+        bool inside = arc.major ? (fromStart >= 0 || toEnd >= 0) : (fromStart >= 0 && toEnd >= 0);
+        if (arc.full || inside) {
+            row[dx] |= mask;
         }
 
-        prevX = x;
-        prevY = y;
-        angle += angleIncrement;
+        fromStart -= arc.startY;
+        toEnd += arc.endY;
     }
+
+    markDirty(xCentre + dxStart, xCentre + dxEnd, y / 8);
 }
 
 
 /*!
-    @brief  Draws triangle specified by x, y positions of corners
-    @param  x1  x coordinate of first corner
-    @param  y1  y coordinate of first corner
-    @param  x2  x coordinate of second corner
-    @param  x2  x coordinate of second corner
-    @param  y3  y coordinate of third corner
-    @param  y3  y coordinate of third corner
+    @brief  Looks up the glyph for a character in the current font.
+            Characters the font lacks fall back to their uppercase form, then to a space. Fonts with an index table
+            resolve this with a single table read, including the fallbacks; others search their code point ranges.
+    @param  c       Character to look up
+    @param  glyph   Set to the PROGMEM address of the glyph's column data
+    @returns Width of glyph in pixels, or 0 if neither the character nor a fallback is in the font
 */
-void SH1106_OLED::drawTriangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t x3, uint8_t y3) {
-    drawLine(x1, y1, x2, y2);
-    drawLine(x2, y2, x3, y3);
-    drawLine(x3, y3, x1, y1);
+uint8_t SH1106_OLED::findGlyph(char c, const uint8_t **glyph) {
+    uint8_t code = c;
+
+    if (font->index) {
+        // Characters outside the index have no glyph of their own, so they take the space's entry
+        uint8_t offset = (uint8_t)(code - font->indexFirst);
+        if (offset >= font->indexCount) {
+            offset = (uint8_t)(' ' - font->indexFirst);
+            if (offset >= font->indexCount) {
+                return 0;
+            }
+        }
+
+        uint8_t entry = pgm_read_byte(&font->index[offset]);
+        return entry ? getGlyph(entry - 1, glyph) : 0;
+    }
+
+    for (uint8_t attempt = 0; attempt < 3; attempt++) {
+        for (uint8_t i = 0; i < font->rangeCount; i++) {
+            uint16_t first = pgm_read_word(&font->ranges[i].first);
+            uint16_t last = pgm_read_word(&font->ranges[i].last);
+            if (code >= first && code <= last) {
+                return getGlyph(pgm_read_word(&font->ranges[i].glyphIndex) + (code - first), glyph);
+            }
+        }
+
+        code = (attempt == 0 && code >= 'a' && code <= 'z') ? code - ('a' - 'A') : ' ';
+    }
+
+    return 0;
 }
 
 
 /*!
-    @brief  Draws filled triangle specified by x, y positions of corners
-    @param  x1  x coordinate of first corner
-    @param  y1  y coordinate of first corner
-    @param  x2  x coordinate of second corner
-    @param  x2  x coordinate of second corner
-    @param  y3  y coordinate of third corner
-    @param  y3  y coordinate of third corner
+    @brief  Finds a glyph of the current font by its position in the font's glyph tables.
+    @param  index   Glyph index
+    @param  glyph   Set to the PROGMEM address of the glyph's column data
+    @returns Width of glyph in pixels
 */
-void SH1106_OLED::drawTriangleFill(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t x3, uint8_t y3) {
-    if (y2 < y1) {
-        swap(y1, y2);
-        swap(x1, x2);
+uint8_t SH1106_OLED::getGlyph(uint16_t index, const uint8_t **glyph) {
+    if (font->fixedWidth) {
+        *glyph = font->bitmaps + (index * font->fixedWidth * ((font->height + 7) / 8));
+        return font->fixedWidth;
+    }
+
+    *glyph = font->bitmaps + pgm_read_word(&font->offsets[index]);
+    return pgm_read_byte(&font->widths[index]);
+}
+
+
+/*!
+    @brief  Draws one glyph of the current font at the current text scale and rotation.
+            Unscaled glyphs are copied straight from the font; scaled or rotated glyphs come from the glyph cache,
+            and are only drawn pixel block by pixel block when too large to cache.
+    @param  c   Character to draw
+    @param  x   x coordinate of left of glyph
+    @param  y   y coordinate of top of glyph
+    @returns Unscaled width of glyph in pixels
+*/
+uint8_t SH1106_OLED::drawChar(char c, int16_t x, int16_t y) {
+    const uint8_t *glyph;
+    uint8_t glyphWidth = findGlyph(c, &glyph);
+    if (glyphWidth == 0) {
+        return 0;
     }
 
-    if (y3 < y2) {
-        swap(y2, y3);
-        swap(x2, x3);
+    if (textScale == 1 && !textRotated) {
+        blit(glyph, NULL, true, (font->height + 7) / 8, 1, x, y, glyphWidth, font->height, BITMAP_OR);
+        return glyphWidth;
     }
 
-    if (y2 < y1) {
-        swap(y1, y2);
-        swap(x1, x2);
+    GlyphCacheEntry *entry = getCachedGlyph(c, glyph, glyphWidth);
+    if (entry) {
+        blit(entry->data, NULL, false, (entry->height + 7) / 8, 1, x, y, entry->width, entry->height, BITMAP_OR);
+    } else {
+        drawExpandedGlyph(glyph, glyphWidth, x, y);
     }
 
-    uint8_t xMin;
-    uint8_t xMax;
-    if (y1 == y3) {
-        xMin = x1;
-        xMax = x3;
-        if (x2 < xMin) {
-            xMin = x2;
-        }
+    return glyphWidth;
+}
 
-        if (x3 < xMin) {
-            xMin = x3;
-        }
 
-        if (x1 > xMax) {
-            xMax = x1;
-        }
+/*!
+    @brief  Finds a glyph at the current text scale and rotation in the glyph cache, expanding it into the least recently used entry on a miss.
+            The cache is allocated the first time it is needed.
+    @param  c           Character of glyph
+    @param  glyph       PROGMEM address of the glyph's column data
+    @param  glyphWidth  Unscaled width of glyph
+    @returns Cache entry holding the expanded glyph, or NULL if it is too large to cache or the cache could not be allocated
+*/
+GlyphCacheEntry *SH1106_OLED::getCachedGlyph(char c, const uint8_t *glyph, uint8_t glyphWidth) {
+    uint16_t expandedWidth = (textRotated ? font->height : glyphWidth) * textScale;
+    uint16_t expandedHeight = (textRotated ? glyphWidth : font->height) * textScale;
+    if (expandedWidth > 0xFF || expandedHeight > 0xFF || expandedWidth * ((expandedHeight + 7) / 8) > GLYPH_CACHE_BYTES) {
+        return NULL;
+    }
 
-        if (x2 > xMax) {
-            xMax = x2;
+    if (!glyphCache) {
+        glyphCache = (GlyphCacheEntry *)malloc(GLYPH_CACHE_SIZE * sizeof(GlyphCacheEntry));
+        if (!glyphCache) {
+            return NULL;
         }
 
-        drawHLine(xMin, xMax, y1);
-        return;
+        memset(glyphCache, 0, GLYPH_CACHE_SIZE * sizeof(GlyphCacheEntry));
     }
 
-    int8_t xDistance12 = x2 - x1, xDistance13 = x3 - x1, xDistance23 = x3 - x2; 
-    int8_t yDistance12 = y2 - y1, yDistance13 = y3 - y1, yDistance23 = y3 - y2;
-    int32_t runAmount12 = 0;
-    int32_t runAmount13 = 0;
-    uint8_t yStop = y2 - 1;
-    if (y2 == y3) {
-        yStop++;
-    }
+    GlyphCacheEntry *oldest = glyphCache;
+    for (uint8_t i = 0; i < GLYPH_CACHE_SIZE; i++) {
+        GlyphCacheEntry *entry = glyphCache + i;
+        if (entry->scale == textScale && entry->rotated == textRotated && entry->code == c && entry->font == font) {
+            entry->lastUsed = ++glyphCacheTick;
+            glyphCacheHits++;
+            return entry;
+        }
 
-    for (uint8_t y = y1; y <= yStop; y++) {
-        xMin = x1 + runAmount12 / yDistance12;
-        xMax = x1 + runAmount13 / yDistance13;
-        runAmount12 += xDistance12;
-        runAmount13 += xDistance13;
-        drawHLine(xMin, xMax, y);
+        if (entry->lastUsed < oldest->lastUsed) {
+            oldest = entry;
+        }
     }
 
-    runAmount13 = (int32_t)xDistance13 * (yStop - y1 + 1);
-    int32_t runAmount23 = (int32_t)xDistance23 * (yStop - y2 + 1);
-    for (uint8_t y = yStop + 1; y < y3; y++) {
-        xMin = x2 + runAmount23 / yDistance23;
-        xMax = x1 + runAmount13 / yDistance13;
-        runAmount13 += xDistance13;
-        runAmount23 += xDistance23;
-        drawHLine(xMin, xMax, y);
-    }
+    glyphCacheMisses++;
+    oldest->font = font;
+    oldest->code = c;
+    oldest->scale = textScale;
+    oldest->rotated = textRotated;
+    oldest->width = expandedWidth;
+    oldest->height = expandedHeight;
+    oldest->lastUsed = ++glyphCacheTick;
+    memset(oldest->data, 0, GLYPH_CACHE_BYTES);
+    expandGlyph(glyph, glyphWidth, oldest->data);
+
+    return oldest;
 }
 
 
 /*!
-    @brief  Draws battery icon with variable charge level to top right corner of screen.
-    @param  percentage  Percentage charge of battery (0-100)
+    @brief  Expands a glyph to the current text scale and rotation as column-major page bytes.
+    @param  glyph       PROGMEM address of the glyph's column data
+    @param  glyphWidth  Unscaled width of glyph
+    @param  expanded    Zeroed destination, large enough for the expanded glyph
 */
-void SH1106_OLED::displayBattery(uint8_t percentage) {
-    uint8_t batteryWidth = 12;
-    uint8_t batteryBitmap[batteryWidth];
+void SH1106_OLED::expandGlyph(const uint8_t *glyph, uint8_t glyphWidth, uint8_t *expanded) {
+    uint8_t bytesPerColumn = (font->height + 7) / 8;
+    uint8_t expandedHeight = (textRotated ? glyphWidth : font->height) * textScale;
+    uint8_t expandedBytesPerColumn = (expandedHeight + 7) / 8;
+
+    for (uint8_t gx = 0; gx < glyphWidth; gx++) {
+        for (uint8_t gy = 0; gy < font->height; gy++) {
+            if (!((pgm_read_byte(glyph + (gx * bytesPerColumn) + (gy / 8)) >> (gy & 0x07)) & 0x01)) {
+                continue;
+            }
 
-    for (int i = 0; i < batteryWidth; i++) {
-        batteryBitmap[i] = pgm_read_byte(batteryCase + i);
+            uint8_t left = (textRotated ? font->height - 1 - gy : gx) * textScale;
+            uint8_t top = (textRotated ? gx : gy) * textScale;
+            for (uint8_t column = left; column < left + textScale; column++) {
+                for (uint8_t row = top; row < top + textScale; row++) {
+                    expanded[(column * expandedBytesPerColumn) + (row / 8)] |= 0x01 << (row & 0x07);
+                }
+            }
+        }
     }
+}
 
-    if (percentage > 5) {
-        batteryBitmap[2] |= pgm_read_byte(batteryLowCell);
-        batteryBitmap[3] |= pgm_read_byte(batteryLowCell + 1);
-    }
 
-    if (percentage > 35) {
-        batteryBitmap[5] |= batteryMidCell;
+/*!
+    @brief  Draws a glyph at the current text scale and rotation directly, one filled block per glyph pixel.
+            Used for glyphs too large for the glyph cache.
+    @param  glyph       PROGMEM address of the glyph's column data
+    @param  glyphWidth  Unscaled width of glyph
+    @param  x           x coordinate of left of glyph
+    @param  y           y coordinate of top of glyph
+*/
+void SH1106_OLED::drawExpandedGlyph(const uint8_t *glyph, uint8_t glyphWidth, int16_t x, int16_t y) {
+    uint8_t bytesPerColumn = (font->height + 7) / 8;
+
+    for (uint8_t gx = 0; gx < glyphWidth; gx++) {
+        for (uint8_t gy = 0; gy < font->height; gy++) {
+            if (!((pgm_read_byte(glyph + (gx * bytesPerColumn) + (gy / 8)) >> (gy & 0x07)) & 0x01)) {
+                continue;
+            }
+
+            int16_t left = x + (textRotated ? font->height - 1 - gy : gx) * textScale;
+            int16_t top = y + (textRotated ? gx : gy) * textScale;
+            fillColumnSpan(max(left, (int16_t)clipX1), min((int16_t)(left + textScale - 1), (int16_t)clipX2),
+                           max(top, (int16_t)clipY1), min((int16_t)(top + textScale - 1), (int16_t)clipY2));
+        }
     }
+}
 
-    if (percentage > 70) {
-        batteryBitmap[7] |= pgm_read_byte(batteryHighCell);
-        batteryBitmap[8] |= pgm_read_byte(batteryHighCell + 1);
+
+/*!
+    @brief  Combines a page-packed image with the screen buffer at any x, y position, clipped to the screen and clip region.
+            Each source byte is shifted to the destination row and written with at most two whole-byte masked writes.
+    @param  source          Address of image data
+    @param  mask            Address of transparency mask in the same layout as source, or NULL to draw every pixel
+    @param  inProgmem       True if source and mask are in PROGMEM, false if they are in RAM
+    @param  columnStride    Bytes between consecutive columns of the same page in source
+    @param  pageStride      Bytes between consecutive pages of the same column in source
+    @param  x               x coordinate of left of image
+    @param  y               y coordinate of top of image
+    @param  w               Width of image in pixels
+    @param  h               Height of image in pixels
+    @param  mode            How source pixels combine with the buffer
+*/
+void SH1106_OLED::blit(const uint8_t *source, const uint8_t *mask, bool inProgmem, uint8_t columnStride, uint16_t pageStride, int16_t x, int16_t y, uint8_t w, uint8_t h, BitmapMode mode) {
+    int16_t firstColumn = max(x, (int16_t)clipX1);
+    int16_t lastColumn = min((int16_t)(x + w - 1), (int16_t)clipX2);
+    if (w == 0 || h == 0 || y > clipY2 || y + h <= clipY1 || firstColumn > lastColumn) {
+        return;
     }
 
-    int bufferIndex = width - batteryWidth;
-    for (int i = 0; i < batteryWidth; i++) {
-        buffer[bufferIndex + i] = batteryBitmap[i];
+    int16_t page = y >> 3;
+    uint8_t shift = y & 0x07;
+    uint8_t sourcePages = (h + 7) / 8;
+
+    for (uint8_t j = 0; j < sourcePages; j++) {
+        // Mask off rows below the image in its last page as well as rows outside the clip region
+        uint8_t valid = (j == sourcePages - 1 && (h & 0x07)) ? 0xFF >> (8 - (h & 0x07)) : 0xFF;
+        uint8_t lowMask, highMask;
+        getBlitMasks(page + j, shift, valid, lowMask, highMask);
+        if (!lowMask && !highMask) {
+            continue;
+        }
+
+        uint16_t sourceOffset = (j * pageStride) + ((firstColumn - x) * columnStride);
+        int16_t lowIndex = ((page + j) * width) + firstColumn;
+        for (int16_t column = firstColumn; column <= lastColumn; column++) {
+            uint8_t b = inProgmem ? pgm_read_byte(source + sourceOffset) : source[sourceOffset];
+            uint8_t m = 0xFF;
+            if (mask) {
+                m = inProgmem ? pgm_read_byte(mask + sourceOffset) : mask[sourceOffset];
+            }
+
+            if (lowMask) {
+                blendByte(lowIndex, b << shift, (m << shift) & lowMask, mode);
+            }
+
+            if (highMask) {
+                blendByte(lowIndex + width, b >> (8 - shift), (m >> (8 - shift)) & highMask, mode);
+            }
+
+            sourceOffset += columnStride;
+            lowIndex++;
+        }
     }
+
+    markDirtyRect(firstColumn, max(y, (int16_t)clipY1), lastColumn, min((int16_t)(y + h - 1), (int16_t)clipY2));
 }
 
 
 /*!
-    @brief  Sends single command to SH1106 OLED screen.
-    @param  command     Byte value for command according to SH1106 datasheet
+    @brief  Finds which rows of the two buffer bytes covered by a shifted source byte may be written.
+    @param  page        Page the top of the source byte falls in
+    @param  shift       Rows the source byte is shifted down by
+    @param  valid       Rows of the source byte that belong to the image
+    @param  lowMask     Set to the writable rows of the byte in page
+    @param  highMask    Set to the writable rows of the byte in the page below
 */
-void SH1106_OLED::sendCommand(uint8_t command) {
-    Wire.beginTransmission(address);
-    uint8_t buf[2] = { 0x00, command };
-    Wire.write(buf, 2);
-    Wire.endTransmission(true);
+void SH1106_OLED::getBlitMasks(int16_t page, uint8_t shift, uint8_t valid, uint8_t &lowMask, uint8_t &highMask) {
+    lowMask = getClipMask(page) & (uint8_t)(valid << shift);
+    highMask = shift ? getClipMask(page + 1) & (valid >> (8 - shift)) : 0;
 }
 
 
 /*!
-    @brief  Sends a dual command/data packet to SH1106 OLED screen.
-    @param  command     Byte value for command according to SH1106 datasheet
-    @param  data        Data value for specified command
+    @brief  Combines source bits with one byte of the screen buffer, touching only the rows in mask.
+    @param  index   Index of byte in buffer
+    @param  bits    Source bits, aligned to the buffer byte
+    @param  mask    Rows of the buffer byte that may change
+    @param  mode    How source bits combine with the buffer
 */
-void SH1106_OLED::sendDualCommand(uint8_t command, uint8_t data) {
-    Wire.beginTransmission(address);
-    uint8_t cmdBuf[2] = { 0x02, command };
-    uint8_t dataBuf[2] = { 0x00, data };
-    Wire.write(cmdBuf, 2);
-    Wire.write(dataBuf, 2);
-    Wire.endTransmission(true);
+inline void SH1106_OLED::blendByte(uint16_t index, uint8_t bits, uint8_t mask, BitmapMode mode) {
+    switch (mode) {
+        case BITMAP_OR:
+            buffer[index] |= bits & mask;
+            break;
+        case BITMAP_AND:
+            buffer[index] &= bits | ~mask;
+            break;
+        case BITMAP_XOR:
+            buffer[index] ^= bits & mask;
+            break;
+        case BITMAP_COPY:
+            buffer[index] = (buffer[index] & ~mask) | (bits & mask);
+            break;
+    }
 }
+
+
+/*!
+    @brief  Returns the rows of a page that lie inside the clip region.
+    @param  page    Page to test
+    @returns Bitmask of rows inside the clip region, or 0 if the page is outside the screen or clip region
+*/
+uint8_t SH1106_OLED::getClipMask(int16_t page) {
+    int16_t top = page * 8;
+    if (page < 0 || page >= pages || clipY2 < top || clipY1 > top + 7) {
+        return 0;
+    }
+
+    uint8_t mask = 0xFF;
+    if (clipY1 > top) {
+        mask &= 0xFF << (clipY1 - top);
+    }
+
+    if (clipY2 < top + 7) {
+        mask &= 0xFF >> (top + 7 - clipY2);
+    }
+
+    return mask;
+}
\ No newline at end of file
@@ -3,11 +3,49 @@
 
 #include <Arduino.h>
 #include <avr/pgmspace.h>
-#include <Wire.h>
-#include <GFX.cpp>
-#include <util.cpp>
+#include "GFX.cpp"
+#include "util.cpp"
+#include "SH1106_Transport.h"
 
-#define WIRE_MAX 32
+#define MAX_PAGES 8
+
+// Columns of display RAM in the SH1106, of which a panel shows width columns starting at its column offset
+#define SH1106_COLUMNS 132
+#define COLUMN_OFFSET_AUTO 0xFF
+
+// Rows of display RAM in the SH1106, at which the display start line wraps whatever the panel height
+#define SH1106_RAM_ROWS 64
+
+// Time after the microcontroller starts before the SH1106 accepts commands, covering supply rise and the module's reset circuit
+#ifndef SH1106_POWER_ON_DELAY
+#define SH1106_POWER_ON_DELAY 10
+#endif
+
+// Time the SH1106's charge pump needs to settle after being switched on before the display may be turned on
+#ifndef SH1106_CHARGE_PUMP_DELAY
+#define SH1106_CHARGE_PUMP_DELAY 100
+#endif
+
+// Settings changed since the last transfer, which are sent together as one command stream when the next transfer finishes
+#define PENDING_START_LINE 0x01
+#define PENDING_CONTRAST 0x02
+#define PENDING_INVERSE 0x04
+#define PENDING_ORIENTATION 0x08
+
+// Number of scaled or rotated glyphs kept pre-expanded, and the largest expanded glyph in bytes that can be cached.
+// Twelve entries hold the digits, a colon and a separator, so a repeatedly printed clock or counter always hits.
+// Boards with 2 KB of RAM or less cache glyphs up to 24 bytes, enough for the built-in fonts at scale 3.
+#ifndef GLYPH_CACHE_SIZE
+#define GLYPH_CACHE_SIZE 12
+#endif
+
+#ifndef GLYPH_CACHE_BYTES
+#if defined(RAMEND) && RAMEND < 0x900
+#define GLYPH_CACHE_BYTES 24
+#else
+#define GLYPH_CACHE_BYTES 64
+#endif
+#endif
 
 enum Corner {
     TOP_LEFT,
@@ -16,22 +54,90 @@ enum Corner {
     BOTTOM_LEFT
 };
 
+enum Orientation {
+    ORIENTATION_NORMAL,
+    ORIENTATION_FLIPPED
+};
+
+enum TextAlign {
+    ALIGN_LEFT,
+    ALIGN_CENTRE,
+    ALIGN_RIGHT
+};
+
+enum BitmapMode {
+    BITMAP_OR,
+    BITMAP_AND,
+    BITMAP_XOR,
+    BITMAP_COPY
+};
+
+#define ALL_CORNERS ((1 << TOP_LEFT) | (1 << TOP_RIGHT) | (1 << BOTTOM_RIGHT) | (1 << BOTTOM_LEFT))
+
+struct GlyphCacheEntry {
+    const Font *font;
+    char code;
+    uint8_t scale;
+    bool rotated;
+    uint8_t width;
+    uint8_t height;
+    uint32_t lastUsed;
+    uint8_t data[GLYPH_CACHE_BYTES];
+};
 
-class SH1106_OLED {
+
+class SH1106_OLED : public Print {
     public:
-        SH1106_OLED(uint8_t width, uint8_t height, uint8_t address);
+        SH1106_OLED(uint8_t width, uint8_t height, uint8_t address, Orientation orientation = ORIENTATION_NORMAL, uint8_t columnOffset = COLUMN_OFFSET_AUTO);
+        SH1106_OLED(uint8_t width, uint8_t height, SH1106_Transport &transport, Orientation orientation = ORIENTATION_NORMAL, uint8_t columnOffset = COLUMN_OFFSET_AUTO);
 
         bool init();
+        void sleep(bool keepChargePump = false);
+        void wake();
+        bool isAsleep();
         void display();
+        void beginDisplay();
+        bool pollDisplay();
+        bool isBusy();
+        bool enableDoubleBuffer(bool diff = false);
         bool getPixel(uint8_t x, uint8_t y);
         void setPixel(uint8_t x, uint8_t y);
         void clearPixel(uint8_t x, uint8_t y);
         void invertPixel(uint8_t x, uint8_t y);
         void clear();
         void invert();
+        void setStartLine(uint8_t line);
+        uint8_t getStartLine();
+        void scroll(int8_t lines);
+        void setInverse(bool inverse);
+        bool isInverse();
+        void setOrientation(Orientation newOrientation);
+        Orientation getOrientation();
+        void setContrast(uint8_t value);
+        uint8_t getContrast();
+        void fadeContrast(uint8_t target, uint16_t duration);
+        bool updateContrastFade();
         void setFontSize(uint8_t size); // gotta think about if I want font size to be a thing
-        void print(String msg, uint8_t x, uint8_t y);
-        void drawBitmap(uint8_t *bitmap, uint8_t x, uint8_t y, uint8_t bitMapWidth, uint8_t bitMapHeight);
+        void setFont(const Font *newFont);
+        void print(const char *msg, uint8_t x, uint8_t y);
+        void print(const __FlashStringHelper *msg, uint8_t x, uint8_t y);
+        void print(const String &msg, uint8_t x, uint8_t y);
+        void printBox(const char *msg, uint8_t x, uint8_t y, uint8_t w, uint8_t h, TextAlign align = ALIGN_LEFT);
+        uint16_t getTextWidth(const char *msg);
+        void setCursor(uint8_t x, uint8_t y);
+        void setTextScale(uint8_t scale);
+        void setTextRotation(bool rotated);
+        uint32_t getGlyphCacheHits();
+        uint32_t getGlyphCacheMisses();
+        virtual size_t write(uint8_t c);
+        using Print::print;
+        using Print::write;
+        void drawBitmap(const uint8_t *bitmap, int16_t x, int16_t y, uint8_t bitmapWidth, uint8_t bitmapHeight, BitmapMode mode = BITMAP_OR, bool inProgmem = true);
+        void drawCompressedBitmap(const uint8_t *data, int16_t x, int16_t y, BitmapMode mode = BITMAP_OR);
+        void drawBitmapMasked(const uint8_t *bitmap, const uint8_t *mask, int16_t x, int16_t y, uint8_t bitmapWidth, uint8_t bitmapHeight, bool inProgmem = true);
+        void setClipRect(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+        void resetClipRect();
+        void getClipRect(int16_t &x1, int16_t &y1, int16_t &x2, int16_t &y2);
         void drawHLine(uint8_t x1, uint8_t x2, uint8_t y);
         void drawVLine(uint8_t y1, uint8_t y2, uint8_t x);
         void drawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
@@ -44,22 +150,385 @@ class SH1106_OLED {
         void drawArc(uint8_t xCentre, uint8_t yCentre, uint8_t radius, Corner corner);
         void drawArcFill(uint8_t xCentre, uint8_t yCentre, uint8_t radius, Corner corner);
         void drawArcRaw(uint8_t xCentre, uint8_t yCentre, uint8_t radius, uint16_t startAngle, uint16_t endAngle);
+        void drawArcThick(uint8_t xCentre, uint8_t yCentre, uint8_t radius, uint8_t thickness, uint16_t startAngle, uint16_t endAngle);
+        void drawPie(uint8_t xCentre, uint8_t yCentre, uint8_t radius, uint16_t startAngle, uint16_t endAngle);
         void drawTriangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t x3, uint8_t y3);
         void drawTriangleFill(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t x3, uint8_t y3);
         void displayBattery(uint8_t percentage);
+        uint32_t getBytesSaved();
+        uint32_t getBytesSent();
+        uint32_t getTransactionCount();
+        uint8_t getWidth();
+        uint8_t getHeight();
+        uint8_t *getBuffer();
+        uint16_t getBufferSize();
+        bool setBuffer(uint8_t *storage);
+        uint16_t getDirtyBytes();
+        bool hasPendingSettings();
+        SH1106_Transport &getTransport();
+        void setTransport(SH1106_Transport &newTransport);
 
-    private:
+    protected:
+        SH1106_OLED(uint8_t width, uint8_t height, uint8_t address, SH1106_Transport *transport, Orientation orientation, uint8_t columnOffset);
         void sendCommand(uint8_t command);
         void sendDualCommand(uint8_t command, uint8_t data);
+        void sendCommands(const SH1106_CommandStream &commands);
+        void waitForChargePump();
+        uint8_t findGlyph(char c, const uint8_t **glyph);
+        uint8_t getGlyph(uint16_t index, const uint8_t **glyph);
+        uint8_t drawChar(char c, int16_t x, int16_t y);
+        GlyphCacheEntry *getCachedGlyph(char c, const uint8_t *glyph, uint8_t glyphWidth);
+        void expandGlyph(const uint8_t *glyph, uint8_t glyphWidth, uint8_t *expanded);
+        void drawExpandedGlyph(const uint8_t *glyph, uint8_t glyphWidth, int16_t x, int16_t y);
+        void blit(const uint8_t *source, const uint8_t *mask, bool inProgmem, uint8_t columnStride, uint16_t pageStride, int16_t x, int16_t y, uint8_t w, uint8_t h, BitmapMode mode);
+        void getBlitMasks(int16_t page, uint8_t shift, uint8_t valid, uint8_t &lowMask, uint8_t &highMask);
+        void blendByte(uint16_t index, uint8_t bits, uint8_t mask, BitmapMode mode);
+        uint8_t getClipMask(int16_t page);
+        void markDirty(uint8_t x1, uint8_t x2, uint8_t page);
+        void markDirtyRect(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
+        void markAllDirty();
+        void clearRows(uint8_t y, uint8_t count);
+        void sendPendingSettings();
+        void seekFlushPage();
+        uint8_t getRamPages(uint8_t page, uint8_t line, uint8_t rowOffset);
+        void moveStartLine(uint8_t line, uint8_t newRamRowOffset);
+        void findChangedSpan(uint8_t page);
+        bool getLineSteps(int16_t majorStart, int8_t majorStep, int16_t majorLow, int16_t majorHigh, int16_t minorStart, int8_t minorStep, int16_t minorLow, int16_t minorHigh, int16_t majorDistance, int16_t minorDistance, int16_t &first, int16_t &last);
+        int16_t getLineOffset(int16_t step, int16_t majorDistance, int16_t minorDistance);
+        void rasteriseLine(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+        void fillArcRing(int16_t xCentre, int16_t yCentre, uint8_t outerRadius, uint8_t innerRadius, const ArcBounds &arc);
+        void fillArcRow(int16_t xCentre, int16_t y, int16_t dy, int16_t dxStart, int16_t dxEnd, const ArcBounds &arc);
+        void fillColumnSpan(int16_t x1, int16_t x2, int16_t y1, int16_t y2);
+        void fillRoundedColumns(int16_t xLeft, int16_t xRight, int16_t yTop, int16_t yBottom, int16_t offset, int16_t extent, uint8_t corners);
+        void fillRounded(int16_t xLeft, int16_t xRight, int16_t yTop, int16_t yBottom, uint8_t radius, uint8_t corners);
+        void plotClipped(int16_t x, int16_t y);
+        template <class Canvas> static void outlineRect(Canvas &canvas, uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+        template <class Canvas> static void outlineRoundedRect(Canvas &canvas, uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t r);
+        template <class Canvas> static void outlineCircle(Canvas &canvas, int16_t xCentre, int16_t yCentre, uint8_t radius);
+        template <class Canvas> static void outlineCorner(Canvas &canvas, int16_t xCentre, int16_t yCentre, uint8_t radius, Corner corner);
+        template <class Canvas> static void outlineArc(Canvas &canvas, int16_t xCentre, int16_t yCentre, uint8_t radius, const ArcBounds &arc);
+        template <class Canvas> static void fillTriangle(Canvas &canvas, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t x3, uint8_t y3);
 
         uint8_t width;
         uint8_t height;
-        uint8_t address;
+        SH1106_I2C i2c;
+        SH1106_Transport *transport;
+        uint8_t pages;
+        uint8_t columnOffset;
+        uint8_t ramColumnOffset;
+        Orientation orientation;
         uint8_t *buffer;
+        uint8_t *frontBuffer;
         uint16_t bufferSize;
+        bool diffMode;
+
+        uint8_t dirtyStart[MAX_PAGES];
+        uint8_t dirtyEnd[MAX_PAGES];
+        uint32_t bytesSaved;
 
-        uint8_t fontSize;
-        const uint8_t *fontSet;
+        uint8_t flushStart[MAX_PAGES];
+        uint8_t flushEnd[MAX_PAGES];
+        uint8_t flushPage;
+        uint8_t flushColumn;
+        uint8_t flushRamPages;
+        uint8_t flushStartLine;
+        uint8_t flushRamRowOffset;
+        uint8_t remapPages;
+        uint8_t startLine;
+        uint8_t ramRowOffset;
+        uint8_t pendingSettings;
+        uint8_t contrast;
+        bool inverse;
+        bool fading;
+        uint8_t fadeFrom;
+        uint8_t fadeTo;
+        uint16_t fadeDuration;
+        uint32_t fadeStart;
+        bool asleep;
+        bool chargePumpOn;
+        uint32_t chargePumpStart;
+
+        const Font *font;
+        uint8_t clipX1;
+        uint8_t clipY1;
+        uint8_t clipX2;
+        uint8_t clipY2;
+        int16_t cursorX;
+        int16_t cursorY;
+        uint8_t textScale;
+        bool textRotated;
+        GlyphCacheEntry *glyphCache;
+        uint32_t glyphCacheTick;
+        uint32_t glyphCacheHits;
+        uint32_t glyphCacheMisses;
 };
 
+// The outline shapes are templates over the display class they draw on, so SH1106_OLED_Fixed can run the same
+// algorithms on its own inlined pixel and line routines, chosen at compile time
+
+/*!
+    @brief  Draws a rectangle outline on a display, using its line routines.
+    @param  canvas  Display to draw on
+    @param  x   Horizontal position of top left corner of rectangle
+    @param  y   Vertical position of top left corner of rectangle
+    @param  w   Width of rectangle in pixels
+    @param  h   Height of rectangle in pixels
+*/
+template <class Canvas>
+void SH1106_OLED::outlineRect(Canvas &canvas, uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+    canvas.drawHLine(x, x + w, y);
+    canvas.drawHLine(x, x + w, y + h);
+    canvas.drawVLine(y, y + h, x);
+    canvas.drawVLine(y, y + h, x + w);
+}
+
+
+/*!
+    @brief  Draws a rounded rectangle outline on a display, using its line and pixel routines.
+    @param  canvas  Display to draw on
+    @param  x   Horizontal position of top left corner of rectangle
+    @param  y   Vertical position of top left corner of rectangle
+    @param  w   Width of rectangle in pixels
+    @param  h   Height of rectangle in pixels
+    @param  r   Radius of rounded corners
+*/
+template <class Canvas>
+void SH1106_OLED::outlineRoundedRect(Canvas &canvas, uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t r) {
+    r = getClampedRadius(w, h, r);
+
+    canvas.drawHLine(x + r, x + w - r, y);
+    canvas.drawHLine(x + r, x + w - r, y + h);
+    canvas.drawVLine(y + r, y + h - r, x);
+    canvas.drawVLine(y + r, y + h - r, x + w);
+
+    outlineCorner(canvas, x + r, y + r, r, TOP_LEFT);
+    outlineCorner(canvas, x + w - r, y + r, r, TOP_RIGHT);
+    outlineCorner(canvas, x + r, y + h - r, r, BOTTOM_LEFT);
+    outlineCorner(canvas, x + w - r, y + h - r, r, BOTTOM_RIGHT);
+}
+
+
+/*!
+    @brief  Draws a circle outline on a display, using its pixel routine. Points outside the clip rectangle are skipped.
+    @param  canvas      Display to draw on
+    @param  xCentre     Centre x coordinate of circle
+    @param  yCentre     Centre y coordinate of circle
+    @param  radius      Radius of circle
+*/
+template <class Canvas>
+void SH1106_OLED::outlineCircle(Canvas &canvas, int16_t xCentre, int16_t yCentre, uint8_t radius) {
+    int16_t f = 1 - radius;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * radius;
+    int16_t x = 0;
+    int16_t y = radius;
+
+    canvas.plotClipped(xCentre, yCentre + radius);
+    canvas.plotClipped(xCentre, yCentre - radius);
+    canvas.plotClipped(xCentre + radius, yCentre);
+    canvas.plotClipped(xCentre - radius, yCentre);
+
+    while (x < y) {
+        if (f >= 0) {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+
+        canvas.plotClipped(xCentre + x, yCentre + y);
+        canvas.plotClipped(xCentre - x, yCentre + y);
+        canvas.plotClipped(xCentre + x, yCentre - y);
+        canvas.plotClipped(xCentre - x, yCentre - y);
+        canvas.plotClipped(xCentre + y, yCentre + x);
+        canvas.plotClipped(xCentre - y, yCentre + x);
+        canvas.plotClipped(xCentre + y, yCentre - x);
+        canvas.plotClipped(xCentre - y, yCentre - x);
+    }
+}
+
+
+/*!
+    @brief  Draws a corner arc on a display, using its pixel routine. Points outside the clip rectangle are skipped.
+    @param  canvas      Display to draw on
+    @param  xCentre     Centre x coordinate of arc
+    @param  yCentre     Centre y coordinate of arc
+    @param  radius      Radius of arc
+    @param  corner      Corner corresponding to arc orientation
+*/
+template <class Canvas>
+void SH1106_OLED::outlineCorner(Canvas &canvas, int16_t xCentre, int16_t yCentre, uint8_t radius, Corner corner) {
+    int16_t f = 1 - radius;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * radius;
+    int16_t x = 0;
+    int16_t y = radius;
+
+    if (corner == BOTTOM_LEFT || corner == BOTTOM_RIGHT) canvas.plotClipped(xCentre, yCentre + radius);
+    if (corner == TOP_LEFT || corner == TOP_RIGHT) canvas.plotClipped(xCentre, yCentre - radius);
+    if (corner == TOP_RIGHT || corner == BOTTOM_RIGHT) canvas.plotClipped(xCentre + radius, yCentre);
+    if (corner == TOP_LEFT || corner == BOTTOM_LEFT) canvas.plotClipped(xCentre - radius, yCentre);
+
+    while (x < y) {
+        if (f >= 0) {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+
+        if (corner == TOP_LEFT) {
+            canvas.plotClipped(xCentre - y, yCentre - x);
+            canvas.plotClipped(xCentre - x, yCentre - y);
+        }
+
+        if (corner == TOP_RIGHT) {
+            canvas.plotClipped(xCentre + x, yCentre - y);
+            canvas.plotClipped(xCentre + y, yCentre - x);
+        }
+
+        if (corner == BOTTOM_RIGHT) {
+            canvas.plotClipped(xCentre + x, yCentre + y);
+            canvas.plotClipped(xCentre + y, yCentre + x);
+        }
+
+        if (corner == BOTTOM_LEFT) {
+            canvas.plotClipped(xCentre - y, yCentre + x);
+            canvas.plotClipped(xCentre - x, yCentre + y);
+        }
+    }
+}
+
+
+/*!
+    @brief  Draws the part of a circle outline inside an angular range on a display, using its pixel routine.
+            Points outside the clip rectangle are skipped.
+    @param  canvas      Display to draw on
+    @param  xCentre     Centre x coordinate of arc
+    @param  yCentre     Centre y coordinate of arc
+    @param  radius      Radius of arc
+    @param  arc         Angular range to draw
+*/
+template <class Canvas>
+void SH1106_OLED::outlineArc(Canvas &canvas, int16_t xCentre, int16_t yCentre, uint8_t radius, const ArcBounds &arc) {
+    int16_t f = 1 - radius;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * radius;
+    int16_t x = 0;
+    int16_t y = radius;
+
+    while (true) {
+        // Midpoint circle walk, keeping each of the eight symmetric points that falls inside the angular range
+        if (isInArc(arc, x, y)) canvas.plotClipped(xCentre + x, yCentre + y);
+        if (isInArc(arc, -x, y)) canvas.plotClipped(xCentre - x, yCentre + y);
+        if (isInArc(arc, x, -y)) canvas.plotClipped(xCentre + x, yCentre - y);
+        if (isInArc(arc, -x, -y)) canvas.plotClipped(xCentre - x, yCentre - y);
+        if (isInArc(arc, y, x)) canvas.plotClipped(xCentre + y, yCentre + x);
+        if (isInArc(arc, -y, x)) canvas.plotClipped(xCentre - y, yCentre + x);
+        if (isInArc(arc, y, -x)) canvas.plotClipped(xCentre + y, yCentre - x);
+        if (isInArc(arc, -y, -x)) canvas.plotClipped(xCentre - y, yCentre - x);
+
+        if (x >= y) {
+            break;
+        }
+
+        if (f >= 0) {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+    }
+}
+
+
+/*!
+    @brief  Draws a filled triangle on a display, one horizontal line per row, using its line routine.
+    @param  canvas  Display to draw on
+    @param  x1  x coordinate of first corner
+    @param  y1  y coordinate of first corner
+    @param  x2  x coordinate of second corner
+    @param  y2  y coordinate of second corner
+    @param  x3  x coordinate of third corner
+    @param  y3  y coordinate of third corner
+*/
+template <class Canvas>
+void SH1106_OLED::fillTriangle(Canvas &canvas, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t x3, uint8_t y3) {
+    if (y2 < y1) {
+        swap(y1, y2);
+        swap(x1, x2);
+    }
+
+    if (y3 < y2) {
+        swap(y2, y3);
+        swap(x2, x3);
+    }
+
+    if (y2 < y1) {
+        swap(y1, y2);
+        swap(x1, x2);
+    }
+
+    uint8_t xMin;
+    uint8_t xMax;
+    if (y1 == y3) {
+        xMin = x1;
+        xMax = x3;
+        if (x2 < xMin) {
+            xMin = x2;
+        }
+
+        if (x3 < xMin) {
+            xMin = x3;
+        }
+
+        if (x1 > xMax) {
+            xMax = x1;
+        }
+
+        if (x2 > xMax) {
+            xMax = x2;
+        }
+
+        canvas.drawHLine(xMin, xMax, y1);
+        return;
+    }
+
+    int8_t xDistance12 = x2 - x1, xDistance13 = x3 - x1, xDistance23 = x3 - x2; 
+    int8_t yDistance12 = y2 - y1, yDistance13 = y3 - y1, yDistance23 = y3 - y2;
+    int32_t runAmount12 = 0;
+    int32_t runAmount13 = 0;
+    uint8_t yStop = y2 - 1;
+    if (y2 == y3) {
+        yStop++;
+    }
+
+    for (uint8_t y = y1; y <= yStop; y++) {
+        xMin = x1 + runAmount12 / yDistance12;
+        xMax = x1 + runAmount13 / yDistance13;
+        runAmount12 += xDistance12;
+        runAmount13 += xDistance13;
+        canvas.drawHLine(xMin, xMax, y);
+    }
+
+    runAmount13 = (int32_t)xDistance13 * (yStop - y1 + 1);
+    int32_t runAmount23 = (int32_t)xDistance23 * (yStop - y2 + 1);
+    for (uint8_t y = yStop + 1; y < y3; y++) {
+        xMin = x2 + runAmount23 / yDistance23;
+        xMax = x1 + runAmount13 / yDistance13;
+        runAmount13 += xDistance13;
+        runAmount23 += xDistance23;
+        canvas.drawHLine(xMin, xMax, y);
+    }
+}
+
 #endif
\ No newline at end of file
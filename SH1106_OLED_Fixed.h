@@ -0,0 +1,324 @@
+#ifndef SH1106_OLED_Fixed_h
+#define SH1106_OLED_Fixed_h
+
+#include "SH1106_OLED.h"
+
+/*!
+    @brief  SH1106 driver for a panel size fixed at compile time.
+            The screen buffer is part of the object, so a global instance needs no heap, and the pixel, line and circle
+            routines below are inlined with the geometry as constants, turning index arithmetic into shifts and constant
+            offsets, and the outline shapes below run the library's shape templates on them. Everything else is inherited
+            from SH1106_OLED. These routines hide the runtime versions rather than override them, so they are chosen at
+            compile time when called on an SH1106_OLED_Fixed, and the runtime versions run when it is used through an
+            SH1106_OLED pointer or reference. Both draw the same pixels and honour the clip rectangle.
+*/
+template <uint8_t WIDTH, uint8_t HEIGHT>
+class SH1106_OLED_Fixed : public SH1106_OLED {
+    friend class SH1106_OLED;
+
+    static_assert(WIDTH > 0 && WIDTH <= SH1106_COLUMNS, "SH1106 panels are at most 132 pixels wide");
+    static_assert(HEIGHT > 0 && HEIGHT <= MAX_PAGES * 8 && (HEIGHT & 0x07) == 0, "SH1106 panel height must be a multiple of 8 up to 64");
+
+    public:
+        /*!
+            @brief  Instantiates a fixed size SH1106_OLED screen object using its own static screen buffer.
+            @param  address         I2C address of SH1106 device
+            @param  orientation     ORIENTATION_NORMAL, or ORIENTATION_FLIPPED to rotate the image 180 degrees
+            @param  columnOffset    First of the SH1106's 132 RAM columns wired to the panel in normal orientation
+        */
+        SH1106_OLED_Fixed(uint8_t address, Orientation orientation = ORIENTATION_NORMAL, uint8_t columnOffset = COLUMN_OFFSET_AUTO) : SH1106_OLED(WIDTH, HEIGHT, address, orientation, columnOffset) {
+            buffer = frame;
+        }
+
+
+        /*!
+            @brief  Instantiates a fixed size SH1106_OLED screen object on a given bus transport, using its own static screen buffer.
+            @param  transport       Transport to the SH1106, which must outlive the display
+            @param  orientation     ORIENTATION_NORMAL, or ORIENTATION_FLIPPED to rotate the image 180 degrees
+            @param  columnOffset    First of the SH1106's 132 RAM columns wired to the panel in normal orientation
+        */
+        SH1106_OLED_Fixed(SH1106_Transport &transport, Orientation orientation = ORIENTATION_NORMAL, uint8_t columnOffset = COLUMN_OFFSET_AUTO) : SH1106_OLED(WIDTH, HEIGHT, transport, orientation, columnOffset) {
+            buffer = frame;
+        }
+
+
+        /*!
+            @brief  Returns the buffer index of the byte holding a pixel.
+            @param  x   x coordinate of pixel
+            @param  y   y coordinate of pixel
+            @returns Index into the screen buffer
+        */
+        static constexpr uint16_t getIndex(uint8_t x, uint8_t y) {
+            return x + ((uint16_t)(y >> 3) * WIDTH);
+        }
+
+
+        /*!
+            @brief  Returns the bit of its buffer byte that holds a pixel row.
+            @param  y   y coordinate of pixel
+            @returns Single bit mask
+        */
+        static constexpr uint8_t getMask(uint8_t y) {
+            return 0x01 << (y & 0x07);
+        }
+
+
+        /*!
+            @brief  Returns the value of the pixel at the specified x, y position.
+            @param  x   x coordinate of pixel
+            @param  y   y coordinate of pixel
+            @returns Boolean true if the pixel is on, false if it is off or out of bounds
+        */
+        bool getPixel(uint8_t x, uint8_t y) {
+            if (x >= WIDTH || y >= HEIGHT) {
+                return false;
+            }
+
+            return buffer[getIndex(x, y)] & getMask(y);
+        }
+
+
+        /*!
+            @brief  Sets the pixel at the specified x, y position to be on, if it is inside the clip rectangle.
+            @param  x   x coordinate of pixel
+            @param  y   y coordinate of pixel
+        */
+        void setPixel(uint8_t x, uint8_t y) {
+            if (x < clipX1 || x > clipX2 || y < clipY1 || y > clipY2) {
+                return;
+            }
+
+            buffer[getIndex(x, y)] |= getMask(y);
+            markColumn(x, y >> 3);
+        }
+
+
+        /*!
+            @brief  Unsets the pixel at the specified x, y position, if it is inside the clip rectangle.
+            @param  x   x coordinate of pixel
+            @param  y   y coordinate of pixel
+        */
+        void clearPixel(uint8_t x, uint8_t y) {
+            if (x < clipX1 || x > clipX2 || y < clipY1 || y > clipY2) {
+                return;
+            }
+
+            buffer[getIndex(x, y)] &= ~getMask(y);
+            markColumn(x, y >> 3);
+        }
+
+
+        /*!
+            @brief  Inverts the pixel at the specified x, y position, if it is inside the clip rectangle.
+            @param  x   x coordinate of pixel
+            @param  y   y coordinate of pixel
+        */
+        void invertPixel(uint8_t x, uint8_t y) {
+            if (x < clipX1 || x > clipX2 || y < clipY1 || y > clipY2) {
+                return;
+            }
+
+            buffer[getIndex(x, y)] ^= getMask(y);
+            markColumn(x, y >> 3);
+        }
+
+
+        /*!
+            @brief  Draws horizontal line from x1 to x2 at vertical position y. Coordinates are clamped to the screen,
+                    then the line is clipped to the clip rectangle.
+            @param  x1  Starting x coordinate of line
+            @param  x2  Ending x coordinate of line
+            @param  y   Vertical position of line
+        */
+        void drawHLine(uint8_t x1, uint8_t x2, uint8_t y) {
+            x1 = min(x1, (uint8_t)(WIDTH - 1));
+            x2 = min(x2, (uint8_t)(WIDTH - 1));
+            y = min(y, (uint8_t)(HEIGHT - 1));
+            if (x2 < x1) {
+                swap(x1, x2);
+            }
+
+            x1 = max(x1, clipX1);
+            x2 = min(x2, clipX2);
+            if (x1 > x2 || y < clipY1 || y > clipY2) {
+                return;
+            }
+
+            uint8_t *row = buffer + getIndex(x1, y);
+            uint8_t mask = getMask(y);
+            for (uint8_t x = x1; x <= x2; x++) {
+                *row++ |= mask;
+            }
+
+            markSpan(x1, x2, y >> 3);
+        }
+
+
+        /*!
+            @brief  Draws vertical line from y1 to y2 at horizontal position x. Coordinates are clamped to the screen,
+                    then the line is clipped to the clip rectangle.
+            @param  y1  Starting y coordinate of line
+            @param  y2  Ending y coordinate of line
+            @param  x   Horizontal position of line
+        */
+        void drawVLine(uint8_t y1, uint8_t y2, uint8_t x) {
+            y1 = min(y1, (uint8_t)(HEIGHT - 1));
+            y2 = min(y2, (uint8_t)(HEIGHT - 1));
+            x = min(x, (uint8_t)(WIDTH - 1));
+            if (y2 < y1) {
+                swap(y1, y2);
+            }
+
+            y1 = max(y1, clipY1);
+            y2 = min(y2, clipY2);
+            if (y1 > y2 || x < clipX1 || x > clipX2) {
+                return;
+            }
+
+            uint8_t firstPage = y1 >> 3;
+            uint8_t lastPage = y2 >> 3;
+            uint8_t topMask = 0xFF << (y1 & 0x07);
+            uint8_t bottomMask = 0xFF >> (7 - (y2 & 0x07));
+            uint8_t *column = buffer + getIndex(x, y1);
+
+            if (firstPage == lastPage) {
+                *column |= topMask & bottomMask;
+                markColumn(x, firstPage);
+                return;
+            }
+
+            *column |= topMask;
+            markColumn(x, firstPage);
+            for (uint8_t page = firstPage + 1; page < lastPage; page++) {
+                column += WIDTH;
+                *column = 0xFF;
+                markColumn(x, page);
+            }
+
+            column[WIDTH] |= bottomMask;
+            markColumn(x, lastPage);
+        }
+
+
+        /*!
+            @brief  Draws a rectange at position x, y with specified width and height.
+            @param  x   Horizontal position of top left corner of rectangle
+            @param  y   Vertical position of top left corner of rectangle
+            @param  w   Width of rectangle in pixels
+            @param  h   Height of rectangle in pixels
+        */
+        void drawRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+            outlineRect(*this, x, y, w, h);
+        }
+
+
+        /*!
+            @brief  Draws a rectange with rounded corners at position x, y with specified width and height and corner radius.
+            @param  x   Horizontal position of top left corner of rectangle
+            @param  y   Vertical position of top left corner of rectangle
+            @param  w   Width of rectangle in pixels
+            @param  h   Height of rectangle in pixels
+            @param  r   Radius of rounded corners
+        */
+        void drawRoundedRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t r) {
+            outlineRoundedRect(*this, x, y, w, h, r);
+        }
+
+
+        /*!
+            @brief  Draws a circle outline with centre at xCentre, yCentre position, with specified radius.
+                    Points outside the clip rectangle are skipped.
+            @param  xCentre     Centre x coordinate of circle
+            @param  yCentre     Centre y coordinate of circle
+            @param  radius      Radius of circle
+        */
+        void drawCircle(uint8_t xCentre, uint8_t yCentre, uint8_t radius) {
+            outlineCircle(*this, xCentre, yCentre, radius);
+        }
+
+
+        /*!
+            @brief  Draws a corner arc with centre at xCentre, yCentre position, with specified radius.
+            @param  xCentre     Centre x coordinate of arc
+            @param  yCentre     Centre y coordinate of arc
+            @param  radius      Radius of arc
+            @param  corner      Corner corresponding to arc orientation
+        */
+        void drawArc(uint8_t xCentre, uint8_t yCentre, uint8_t radius, Corner corner) {
+            outlineCorner(*this, xCentre, yCentre, radius, corner);
+        }
+
+
+        /*!
+            @brief  Draws an arc with centre at xCentre, yCentre position, with specified radius between start and end angles.
+                    Angles follow the same convention as SH1106_OLED::drawArcRaw().
+            @param  xCentre     Centre x coordinate of arc
+            @param  yCentre     Centre y coordinate of arc
+            @param  radius      Radius of arc
+            @param  startAngle  Angle corresponding to start of arc
+            @param  endAngle    Angle corresponding to end of arc
+        */
+        void drawArcRaw(uint8_t xCentre, uint8_t yCentre, uint8_t radius, uint16_t startAngle, uint16_t endAngle) {
+            if (startAngle != endAngle) {
+                outlineArc(*this, xCentre, yCentre, radius, getArcBounds(startAngle, endAngle));
+            }
+        }
+
+
+        /*!
+            @brief  Draws filled triangle specified by x, y positions of corners
+            @param  x1  x coordinate of first corner
+            @param  y1  y coordinate of first corner
+            @param  x2  x coordinate of second corner
+            @param  y2  y coordinate of second corner
+            @param  x3  x coordinate of third corner
+            @param  y3  y coordinate of third corner
+        */
+        void drawTriangleFill(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t x3, uint8_t y3) {
+            fillTriangle(*this, x1, y1, x2, y2, x3, y3);
+        }
+
+    private:
+        /*!
+            @brief  Sets a pixel given signed coordinates, skipping it if it is outside the clip rectangle.
+            @param  x   x coordinate of pixel
+            @param  y   y coordinate of pixel
+        */
+        void plotClipped(int16_t x, int16_t y) {
+            if (x >= clipX1 && x <= clipX2 && y >= clipY1 && y <= clipY2) {
+                buffer[getIndex(x, y)] |= getMask(y);
+                markColumn(x, y >> 3);
+            }
+        }
+
+
+        /*!
+            @brief  Records one column of an on-screen page as modified.
+            @param  x       Column modified
+            @param  page    Page modified
+        */
+        void markColumn(uint8_t x, uint8_t page) {
+            markSpan(x, x, page);
+        }
+
+
+        /*!
+            @brief  Records an on-screen column span of a page as modified, without the range checks of markDirty().
+            @param  x1      First column modified
+            @param  x2      Last column modified, not less than x1
+            @param  page    Page modified
+        */
+        void markSpan(uint8_t x1, uint8_t x2, uint8_t page) {
+            if (x1 < dirtyStart[page]) {
+                dirtyStart[page] = x1;
+            }
+
+            if (x2 > dirtyEnd[page]) {
+                dirtyEnd[page] = x2;
+            }
+        }
+
+        uint8_t frame[WIDTH * (HEIGHT / 8)];
+};
+
+#endif
@@ -0,0 +1,310 @@
+#include "SH1106_Sprites.h"
+
+/*!
+    @brief  Instantiates a sprite layer drawing to a display. Sprites are composited over a copy of the screen
+            taken with captureBackground(), or taken automatically on the first update().
+    @param  oled    Display to draw sprites on
+*/
+SH1106_Sprites::SH1106_Sprites(SH1106_OLED &oled) : oled(oled), background(NULL), spriteCount(0), dirtyCount(0) {
+    for (uint8_t i = 0; i < MAX_SPRITES; i++) {
+        sprites[i].frames = NULL;
+    }
+}
+
+
+/*!
+    @brief  Copies the current screen buffer as the background that sprites are drawn over and restored from.
+            Call this after drawing the static parts of the screen and before sprites are first drawn,
+            or again whenever the static parts change while no sprites are visible.
+    @returns True if the background could be allocated, false if not
+*/
+bool SH1106_Sprites::captureBackground() {
+    uint16_t size = oled.getWidth() * (oled.getHeight() / 8);
+    if (!background) {
+        background = (uint8_t *)malloc(size);
+        if (!background) {
+            return false;
+        }
+    }
+
+    memcpy(background, oled.getBuffer(), size);
+    return true;
+}
+
+
+/*!
+    @brief  Adds a sprite to the layer. It is drawn on the next update().
+    @param  frames      PROGMEM address of the sprite's frames, each a bitmap as used by drawBitmap(), stored one after another
+    @param  width       Width of sprite in pixels
+    @param  height      Height of sprite in pixels
+    @param  frameCount  Number of frames
+    @param  x           x coordinate of left of sprite, may be off screen
+    @param  y           y coordinate of top of sprite, may be off screen
+    @param  z           Drawing order, sprites with higher z are drawn over those with lower z
+    @param  masks       PROGMEM address of a transparency mask for each frame in the same layout as frames,
+                        or NULL to OR the sprite over the background
+    @returns Id of sprite, or NO_SPRITE if the layer is full
+*/
+uint8_t SH1106_Sprites::addSprite(const uint8_t *frames, uint8_t width, uint8_t height, uint8_t frameCount, int16_t x, int16_t y, int8_t z, const uint8_t *masks) {
+    for (uint8_t id = 0; id < MAX_SPRITES; id++) {
+        Sprite &sprite = sprites[id];
+        if (sprite.frames) {
+            continue;
+        }
+
+        sprite.frames = frames;
+        sprite.masks = masks;
+        sprite.width = width;
+        sprite.height = height;
+        sprite.frameCount = frameCount ? frameCount : 1;
+        sprite.frame = 0;
+        sprite.x = x;
+        sprite.y = y;
+        sprite.z = z;
+        sprite.visible = true;
+        sprite.changed = true;
+        sprite.drawn = false;
+
+        order[spriteCount++] = id;
+        sortSprites();
+        return id;
+    }
+
+    return NO_SPRITE;
+}
+
+
+/*!
+    @brief  Removes a sprite from the layer. The background under it is restored on the next update().
+    @param  id  Id of sprite
+*/
+void SH1106_Sprites::removeSprite(uint8_t id) {
+    if (id >= MAX_SPRITES || !sprites[id].frames) {
+        return;
+    }
+
+    Sprite &sprite = sprites[id];
+    if (sprite.drawn) {
+        addDirtyRect(sprite.drawnX, sprite.drawnY, sprite.drawnX + sprite.width - 1, sprite.drawnY + sprite.height - 1);
+    }
+
+    sprite.frames = NULL;
+    for (uint8_t i = 0; i < spriteCount; i++) {
+        if (order[i] == id) {
+            memmove(order + i, order + i + 1, spriteCount - i - 1);
+            spriteCount--;
+            break;
+        }
+    }
+}
+
+
+/*!
+    @brief  Moves a sprite. The change is drawn on the next update().
+    @param  id  Id of sprite
+    @param  x   x coordinate of left of sprite, may be off screen
+    @param  y   y coordinate of top of sprite, may be off screen
+*/
+void SH1106_Sprites::moveSprite(uint8_t id, int16_t x, int16_t y) {
+    if (id >= MAX_SPRITES || !sprites[id].frames || (sprites[id].x == x && sprites[id].y == y)) {
+        return;
+    }
+
+    sprites[id].x = x;
+    sprites[id].y = y;
+    sprites[id].changed = true;
+}
+
+
+/*!
+    @brief  Selects the frame a sprite shows. The change is drawn on the next update().
+    @param  id      Id of sprite
+    @param  frame   Frame index, wrapped to the sprite's frame count
+*/
+void SH1106_Sprites::setFrame(uint8_t id, uint8_t frame) {
+    if (id >= MAX_SPRITES || !sprites[id].frames) {
+        return;
+    }
+
+    frame %= sprites[id].frameCount;
+    if (sprites[id].frame != frame) {
+        sprites[id].frame = frame;
+        sprites[id].changed = true;
+    }
+}
+
+
+/*!
+    @brief  Advances a sprite to its next frame, wrapping back to the first.
+    @param  id  Id of sprite
+*/
+void SH1106_Sprites::nextFrame(uint8_t id) {
+    if (id < MAX_SPRITES && sprites[id].frames) {
+        setFrame(id, (sprites[id].frame + 1) % sprites[id].frameCount);
+    }
+}
+
+
+/*!
+    @brief  Shows or hides a sprite. The change is drawn on the next update().
+    @param  id      Id of sprite
+    @param  visible True to show sprite, false to hide it
+*/
+void SH1106_Sprites::setVisible(uint8_t id, bool visible) {
+    if (id >= MAX_SPRITES || !sprites[id].frames || sprites[id].visible == visible) {
+        return;
+    }
+
+    sprites[id].visible = visible;
+    sprites[id].changed = true;
+}
+
+
+/*!
+    @brief  Changes the drawing order of a sprite. The change is drawn on the next update().
+    @param  id  Id of sprite
+    @param  z   Drawing order, sprites with higher z are drawn over those with lower z
+*/
+void SH1106_Sprites::setZ(uint8_t id, int8_t z) {
+    if (id >= MAX_SPRITES || !sprites[id].frames || sprites[id].z == z) {
+        return;
+    }
+
+    sprites[id].z = z;
+    sprites[id].changed = true;
+    sortSprites();
+}
+
+
+/*!
+    @brief  Composites every sprite that moved, changed frame, appeared or disappeared since the last update.
+            Only the rectangles they covered before and cover now are restored from the background and redrawn,
+            and only those areas are marked for the next display().
+            Drawing stays inside the display's clip rectangle, which is left as it was.
+    @returns Number of rectangles redrawn
+*/
+uint8_t SH1106_Sprites::update() {
+    if (!background && !captureBackground()) {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < spriteCount; i++) {
+        Sprite &sprite = sprites[order[i]];
+        if (!sprite.changed) {
+            continue;
+        }
+
+        if (sprite.drawn) {
+            addDirtyRect(sprite.drawnX, sprite.drawnY, sprite.drawnX + sprite.width - 1, sprite.drawnY + sprite.height - 1);
+        }
+
+        if (sprite.visible) {
+            addDirtyRect(sprite.x, sprite.y, sprite.x + sprite.width - 1, sprite.y + sprite.height - 1);
+        }
+
+        sprite.drawn = sprite.visible;
+        sprite.drawnX = sprite.x;
+        sprite.drawnY = sprite.y;
+        sprite.changed = false;
+    }
+
+    DirtyRect clip;
+    oled.getClipRect(clip.x1, clip.y1, clip.x2, clip.y2);
+    uint8_t redrawn = dirtyCount;
+    for (uint8_t i = 0; i < dirtyCount; i++) {
+        redrawRect(dirtyRects[i], clip);
+    }
+
+    dirtyCount = 0;
+    oled.setClipRect(clip.x1, clip.y1, clip.x2, clip.y2);
+    return redrawn;
+}
+
+
+/*!
+    @brief  Adds an area to redraw, merging it with any pending areas it overlaps or touches so no pixel is drawn twice.
+            When the list is full the area is merged into the last entry instead.
+    @param  x1  x coordinate of left of area
+    @param  y1  y coordinate of top of area
+    @param  x2  x coordinate of right of area
+    @param  y2  y coordinate of bottom of area
+*/
+void SH1106_Sprites::addDirtyRect(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    uint8_t i = 0;
+    while (i < dirtyCount) {
+        DirtyRect &rect = dirtyRects[i];
+        if (x1 > rect.x2 + 1 || x2 < rect.x1 - 1 || y1 > rect.y2 + 1 || y2 < rect.y1 - 1) {
+            i++;
+            continue;
+        }
+
+        // Absorb the overlapping area and check the grown area against the others again
+        x1 = min(x1, rect.x1);
+        y1 = min(y1, rect.y1);
+        x2 = max(x2, rect.x2);
+        y2 = max(y2, rect.y2);
+        dirtyRects[i] = dirtyRects[--dirtyCount];
+        i = 0;
+    }
+
+    if (dirtyCount == 2 * MAX_SPRITES) {
+        DirtyRect &last = dirtyRects[dirtyCount - 1];
+        last.x1 = min(x1, last.x1);
+        last.y1 = min(y1, last.y1);
+        last.x2 = max(x2, last.x2);
+        last.y2 = max(y2, last.y2);
+        return;
+    }
+
+    DirtyRect &rect = dirtyRects[dirtyCount++];
+    rect.x1 = x1;
+    rect.y1 = y1;
+    rect.x2 = x2;
+    rect.y2 = y2;
+}
+
+
+/*!
+    @brief  Orders sprite ids by z, keeping the order sprites were added in for equal z.
+*/
+void SH1106_Sprites::sortSprites() {
+    for (uint8_t i = 1; i < spriteCount; i++) {
+        uint8_t id = order[i];
+        uint8_t j = i;
+        while (j > 0 && sprites[order[j - 1]].z > sprites[id].z) {
+            order[j] = order[j - 1];
+            j--;
+        }
+
+        order[j] = id;
+    }
+}
+
+
+/*!
+    @brief  Restores an area from the background and draws the visible sprites that overlap it, lowest z first.
+    @param  rect    Area to redraw
+    @param  clip    Caller's clip rectangle, which the area is limited to
+*/
+void SH1106_Sprites::redrawRect(const DirtyRect &rect, const DirtyRect &clip) {
+    if (rect.x2 < clip.x1 || rect.y2 < clip.y1 || rect.x1 > clip.x2 || rect.y1 > clip.y2) {
+        return;
+    }
+
+    oled.setClipRect(max(rect.x1, clip.x1), max(rect.y1, clip.y1), min(rect.x2, clip.x2), min(rect.y2, clip.y2));
+    oled.drawBitmap(background, 0, 0, oled.getWidth(), oled.getHeight(), BITMAP_COPY, false);
+
+    for (uint8_t i = 0; i < spriteCount; i++) {
+        Sprite &sprite = sprites[order[i]];
+        if (!sprite.visible || sprite.x > rect.x2 || sprite.x + sprite.width <= rect.x1 || sprite.y > rect.y2 || sprite.y + sprite.height <= rect.y1) {
+            continue;
+        }
+
+        uint16_t frameOffset = sprite.frame * sprite.width * ((sprite.height + 7) / 8);
+        if (sprite.masks) {
+            oled.drawBitmapMasked(sprite.frames + frameOffset, sprite.masks + frameOffset, sprite.x, sprite.y, sprite.width, sprite.height);
+        } else {
+            oled.drawBitmap(sprite.frames + frameOffset, sprite.x, sprite.y, sprite.width, sprite.height);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef SH1106_Sprites_h
+#define SH1106_Sprites_h
+
+#include "SH1106_OLED.h"
+
+// Number of sprites a sprite layer can hold
+#ifndef MAX_SPRITES
+#define MAX_SPRITES 8
+#endif
+
+#define NO_SPRITE 0xFF
+
+struct Sprite {
+    const uint8_t *frames;
+    const uint8_t *masks;
+    uint8_t width;
+    uint8_t height;
+    uint8_t frameCount;
+    uint8_t frame;
+    int16_t x;
+    int16_t y;
+    int8_t z;
+    bool visible;
+    bool changed;
+    bool drawn;
+    int16_t drawnX;
+    int16_t drawnY;
+};
+
+struct DirtyRect {
+    int16_t x1;
+    int16_t y1;
+    int16_t x2;
+    int16_t y2;
+};
+
+
+class SH1106_Sprites {
+    public:
+        SH1106_Sprites(SH1106_OLED &oled);
+
+        bool captureBackground();
+        uint8_t addSprite(const uint8_t *frames, uint8_t width, uint8_t height, uint8_t frameCount, int16_t x, int16_t y, int8_t z = 0, const uint8_t *masks = NULL);
+        void removeSprite(uint8_t id);
+        void moveSprite(uint8_t id, int16_t x, int16_t y);
+        void setFrame(uint8_t id, uint8_t frame);
+        void nextFrame(uint8_t id);
+        void setVisible(uint8_t id, bool visible);
+        void setZ(uint8_t id, int8_t z);
+        uint8_t update();
+
+    private:
+        void addDirtyRect(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+        void sortSprites();
+        void redrawRect(const DirtyRect &rect, const DirtyRect &clip);
+
+        SH1106_OLED &oled;
+        uint8_t *background;
+        Sprite sprites[MAX_SPRITES];
+        uint8_t order[MAX_SPRITES];
+        uint8_t spriteCount;
+        DirtyRect dirtyRects[2 * MAX_SPRITES];
+        uint8_t dirtyCount;
+};
+
+#endif
@@ -0,0 +1,421 @@
+#include "SH1106_Transport.h"
+
+/*!
+    @brief  Instantiates an empty command stream.
+*/
+SH1106_CommandStream::SH1106_CommandStream() : length(0) {}
+
+
+/*!
+    @brief  Appends a single byte command to the stream.
+    @param  command     Byte value for command according to SH1106 datasheet
+    @returns Boolean true if the command was added, false if the stream is full
+*/
+bool SH1106_CommandStream::add(uint8_t command) {
+    if (length >= SH1106_COMMAND_STREAM_SIZE) {
+        return false;
+    }
+
+    commands[length++] = command;
+    return true;
+}
+
+
+/*!
+    @brief  Appends a command and its argument byte to the stream. Neither is added if both do not fit.
+    @param  command     Byte value for command according to SH1106 datasheet
+    @param  argument    Argument value for specified command
+    @returns Boolean true if the command was added, false if the stream is full
+*/
+bool SH1106_CommandStream::add(uint8_t command, uint8_t argument) {
+    if (length + 2 > SH1106_COMMAND_STREAM_SIZE) {
+        return false;
+    }
+
+    commands[length++] = command;
+    commands[length++] = argument;
+    return true;
+}
+
+
+/*!
+    @brief  Appends a sequence of commands stored in PROGMEM to the stream. Nothing is added if they do not all fit.
+    @param  commands    Command bytes in PROGMEM, including any argument bytes
+    @param  count       Number of bytes
+    @returns Boolean true if the commands were added, false if the stream is full
+*/
+bool SH1106_CommandStream::addProgmem(const uint8_t *commands, uint8_t count) {
+    if (length + count > SH1106_COMMAND_STREAM_SIZE) {
+        return false;
+    }
+
+    memcpy_P(this->commands + length, commands, count);
+    length += count;
+    return true;
+}
+
+
+/*!
+    @brief  Empties the stream so it can be reused.
+*/
+void SH1106_CommandStream::clear() {
+    length = 0;
+}
+
+
+/*!
+    @brief  Returns the command bytes collected so far.
+    @returns Pointer to command bytes
+*/
+const uint8_t *SH1106_CommandStream::getCommands() const {
+    return commands;
+}
+
+
+/*!
+    @brief  Returns the number of command bytes collected so far.
+    @returns Number of bytes
+*/
+uint8_t SH1106_CommandStream::getLength() const {
+    return length;
+}
+
+
+/*!
+    @brief  Instantiates a transport with cleared statistics.
+*/
+SH1106_Transport::SH1106_Transport() : bytesSent(0), transactions(0) {}
+
+
+/*!
+    @brief  Returns whether a background transfer is still in progress. Blocking transports are never busy.
+    @returns Boolean true if the transport cannot accept another transfer yet
+*/
+bool SH1106_Transport::isBusy() {
+    return false;
+}
+
+
+/*!
+    @brief  Returns the running count of bytes written to the bus, including control and command bytes.
+    @returns Number of bytes sent since initialisation
+*/
+uint32_t SH1106_Transport::getBytesSent() {
+    return bytesSent;
+}
+
+
+/*!
+    @brief  Returns the running count of bus transactions sent to the SH1106.
+    @returns Number of transactions since initialisation
+*/
+uint32_t SH1106_Transport::getTransactionCount() {
+    return transactions;
+}
+
+
+/*!
+    @brief  Instantiates an I2C transport.
+    @param  address I2C address of SH1106 device
+    @param  wire    I2C bus the SH1106 is on
+    @param  clock   I2C clock frequency in Hz
+*/
+SH1106_I2C::SH1106_I2C(uint8_t address, TwoWire &wire, uint32_t clock) : wire(wire), address(address), clock(clock), nextPage(0xFF), nextColumn(0) {}
+
+
+/*!
+    @brief  Starts the I2C bus at the configured clock.
+*/
+void SH1106_I2C::begin() {
+    wire.begin();
+    wire.setClock(clock);
+}
+
+
+/*!
+    @brief  Sends commands as a command stream, as many per transaction as the Wire buffer holds.
+    @param  commands    Command bytes, including any argument bytes
+    @param  count       Number of bytes
+*/
+void SH1106_I2C::sendCommands(const uint8_t *commands, uint8_t count) {
+    // Commands may move the RAM address, so the next data must set it again
+    nextPage = 0xFF;
+
+    while (count) {
+        uint8_t chunk = min(count, (uint8_t)(WIRE_MAX - 1));
+        wire.beginTransmission(address);
+        wire.write(SH1106_CONTROL_COMMAND_STREAM);
+        wire.write(commands, chunk);
+        wire.endTransmission(true);
+        bytesSent += chunk + 1;
+        transactions++;
+
+        commands += chunk;
+        count -= chunk;
+    }
+}
+
+
+/*!
+    @brief  Writes display data in one transaction of up to WIRE_MAX bytes.
+            Page and column addressing share the transaction with the data using continuation control bytes. Only the
+            address commands whose values differ from where the previous transaction left the controller are sent, so data
+            continuing where the last transaction ended needs none, and the next page of a full-width span usually needs
+            just the page and upper column commands.
+    @param  page    Page to write
+    @param  column  RAM column to start at
+    @param  data    Display data
+    @param  count   Number of bytes remaining to write
+    @returns Number of bytes written
+*/
+uint16_t SH1106_I2C::sendData(uint8_t page, uint8_t column, const uint8_t *data, uint16_t count) {
+    uint8_t header[7];
+    uint8_t length = 0;
+    bool known = nextPage != 0xFF;
+
+    if (page != nextPage) {
+        header[length++] = SH1106_CONTROL_COMMAND;
+        header[length++] = 0xB0 + page;
+    }
+
+    if (!known || (column >> 4) != (nextColumn >> 4)) {
+        header[length++] = SH1106_CONTROL_COMMAND;
+        header[length++] = 0x10 | (column >> 4);
+    }
+
+    if (!known || (column & 0x0F) != (nextColumn & 0x0F)) {
+        header[length++] = SH1106_CONTROL_COMMAND;
+        header[length++] = column & 0x0F;
+    }
+
+    header[length++] = SH1106_CONTROL_DATA_STREAM;
+    uint16_t chunk = min(count, (uint16_t)(WIRE_MAX - length));
+
+    wire.beginTransmission(address);
+    wire.write(header, length);
+    wire.write(data, chunk);
+    wire.endTransmission(true);
+    bytesSent += length + chunk;
+    transactions++;
+
+    nextPage = page;
+    nextColumn = column + chunk;
+    return chunk;
+}
+
+
+/*!
+    @brief  Instantiates a 4-wire SPI transport.
+    @param  dcPin   Pin driving the SH1106 data/command input
+    @param  csPin   Pin driving the SH1106 chip select input
+    @param  spi     SPI bus the SH1106 is on
+    @param  clock   SPI clock frequency in Hz
+*/
+SH1106_SPI::SH1106_SPI(uint8_t dcPin, uint8_t csPin, SPIClass &spi, uint32_t clock) : spi(spi), dcPin(dcPin), csPin(csPin), clock(clock) {}
+
+
+/*!
+    @brief  Configures the control pins and starts the SPI bus.
+*/
+void SH1106_SPI::begin() {
+    pinMode(dcPin, OUTPUT);
+    pinMode(csPin, OUTPUT);
+    digitalWrite(csPin, HIGH);
+    spi.begin();
+}
+
+
+/*!
+    @brief  Sends command bytes with the data/command input low.
+    @param  commands    Command bytes, including any argument bytes
+    @param  count       Number of bytes
+*/
+void SH1106_SPI::sendCommands(const uint8_t *commands, uint8_t count) {
+    spi.beginTransaction(SPISettings(clock, MSBFIRST, SPI_MODE0));
+    digitalWrite(dcPin, LOW);
+    digitalWrite(csPin, LOW);
+    writeBytes(commands, count);
+    digitalWrite(csPin, HIGH);
+    spi.endTransaction();
+
+    bytesSent += count;
+    transactions++;
+}
+
+
+/*!
+    @brief  Sets the page and column address and writes all of the display data in one chip select cycle.
+            SPI has no transaction size limit, so the whole span is always sent.
+    @param  page    Page to write
+    @param  column  RAM column to start at
+    @param  data    Display data
+    @param  count   Number of bytes to write
+    @returns Number of bytes written
+*/
+uint16_t SH1106_SPI::sendData(uint8_t page, uint8_t column, const uint8_t *data, uint16_t count) {
+    uint8_t cmd[] = {
+        (uint8_t)(0xB0 + page),
+        (uint8_t)(0x10 | (column >> 4)),
+        (uint8_t)(column & 0x0F)
+    };
+
+    spi.beginTransaction(SPISettings(clock, MSBFIRST, SPI_MODE0));
+    digitalWrite(dcPin, LOW);
+    digitalWrite(csPin, LOW);
+    writeBytes(cmd, sizeof(cmd));
+    digitalWrite(dcPin, HIGH);
+    writeBytes(data, count);
+    digitalWrite(csPin, HIGH);
+    spi.endTransaction();
+
+    bytesSent += sizeof(cmd) + count;
+    transactions++;
+    return count;
+}
+
+
+/*!
+    @brief  Clocks bytes out on the SPI bus without modifying the source, unlike the buffer form of SPI.transfer().
+    @param  bytes   Bytes to write
+    @param  count   Number of bytes
+*/
+void SH1106_SPI::writeBytes(const uint8_t *bytes, uint16_t count) {
+    while (count--) {
+        spi.transfer(*bytes++);
+    }
+}
+
+
+/*!
+    @brief  Instantiates a background transport with no transfer in progress.
+*/
+SH1106_AsyncTransport::SH1106_AsyncTransport() : busy(false) {}
+
+
+/*!
+    @brief  Returns whether the last transfer started is still in progress.
+    @returns Boolean true until transferComplete() is called
+*/
+bool SH1106_AsyncTransport::isBusy() {
+    return busy;
+}
+
+
+/*!
+    @brief  Marks the transfer in progress as finished. Call from the DMA completion interrupt or callback.
+*/
+void SH1106_AsyncTransport::transferComplete() {
+    busy = false;
+}
+
+
+/*!
+    @brief  Marks a transfer as in progress. Call from sendData() or sendCommands() when starting a background transfer.
+*/
+void SH1106_AsyncTransport::startTransfer() {
+    busy = true;
+}
+
+
+/*!
+    @brief  Instantiates a multiplexer with no channel open.
+    @param  address I2C address of the multiplexer
+    @param  wire    I2C bus the multiplexer is on
+*/
+SH1106_Mux::SH1106_Mux(uint8_t address, TwoWire &wire) : wire(wire), address(address), channel(NO_MUX_CHANNEL), owner(NULL) {}
+
+
+/*!
+    @brief  Routes the bus to a channel, skipping the write if it is already selected. Devices on the main bus close every
+            channel, so they cannot clash with a device at the same address behind the multiplexer.
+            A background transfer through the channel open before is allowed to finish first.
+    @param  channel     Channel to select, or NO_MUX_CHANNEL for a device on the main bus
+    @param  transport   Transport about to use the bus
+*/
+void SH1106_Mux::select(uint8_t channel, SH1106_Transport *transport) {
+    if (channel != this->channel) {
+        while (owner && owner->isBusy());
+        wire.beginTransmission(address);
+        wire.write(channel == NO_MUX_CHANNEL ? 0x00 : 0x01 << channel);
+        wire.endTransmission(true);
+        this->channel = channel;
+    }
+
+    owner = transport;
+}
+
+
+/*!
+    @brief  Returns the channel currently open.
+    @returns Channel number, or NO_MUX_CHANNEL if every channel is closed
+*/
+uint8_t SH1106_Mux::getChannel() {
+    return channel;
+}
+
+
+/*!
+    @brief  Instantiates a transport that reaches an SH1106 through a multiplexer channel.
+    @param  mux         Multiplexer the display is behind, which must outlive the transport
+    @param  channel     Channel the display is wired to, or NO_MUX_CHANNEL if it is on the main bus
+    @param  transport   Transport to the SH1106 once the channel is open, which must outlive this one
+*/
+SH1106_MuxTransport::SH1106_MuxTransport(SH1106_Mux *mux, uint8_t channel, SH1106_Transport *transport) : mux(mux), channel(channel), transport(transport) {
+    if (transport) {
+        updateCounts();
+    }
+}
+
+
+/*!
+    @brief  Starts the wrapped transport.
+*/
+void SH1106_MuxTransport::begin() {
+    transport->begin();
+}
+
+
+/*!
+    @brief  Selects the channel, then sends commands through the wrapped transport.
+    @param  commands    Command bytes, including any argument bytes
+    @param  count       Number of bytes
+*/
+void SH1106_MuxTransport::sendCommands(const uint8_t *commands, uint8_t count) {
+    mux->select(channel, transport);
+    transport->sendCommands(commands, count);
+    updateCounts();
+}
+
+
+/*!
+    @brief  Selects the channel, then sends display data through the wrapped transport.
+    @param  page    Page to write
+    @param  column  RAM column to start at
+    @param  data    Display data
+    @param  count   Number of bytes
+    @returns Number of bytes sent
+*/
+uint16_t SH1106_MuxTransport::sendData(uint8_t page, uint8_t column, const uint8_t *data, uint16_t count) {
+    mux->select(channel, transport);
+    uint16_t sent = transport->sendData(page, column, data, count);
+    updateCounts();
+    return sent;
+}
+
+
+/*!
+    @brief  Returns whether the wrapped transport is still sending in the background.
+    @returns Boolean true if the transport cannot accept another transfer yet
+*/
+bool SH1106_MuxTransport::isBusy() {
+    return transport->isBusy();
+}
+
+
+/*!
+    @brief  Copies the statistics of the wrapped transport, so the display reports its traffic. Multiplexer writes are not counted.
+*/
+void SH1106_MuxTransport::updateCounts() {
+    bytesSent = transport->getBytesSent();
+    transactions = transport->getTransactionCount();
+}
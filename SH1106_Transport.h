@@ -0,0 +1,180 @@
+#ifndef SH1106_Transport_h
+#define SH1106_Transport_h
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <SPI.h>
+
+// Largest I2C transaction the platform's Wire library can buffer
+#ifndef WIRE_MAX
+#if defined(I2C_BUFFER_LENGTH)
+#define WIRE_MAX I2C_BUFFER_LENGTH
+#elif defined(WIRE_BUFFER_SIZE)
+#define WIRE_MAX WIRE_BUFFER_SIZE
+#elif defined(BUFFER_LENGTH)
+#define WIRE_MAX BUFFER_LENGTH
+#else
+#define WIRE_MAX 32
+#endif
+#endif
+
+// The SH1106 accepts serial clocks up to 4 MHz
+#define SH1106_SPI_CLOCK 4000000
+
+// I2C control bytes. Co (bit 7) set means another control byte follows the next byte, and D/C# (bit 6) set means data
+#define SH1106_CONTROL_COMMAND_STREAM 0x00
+#define SH1106_CONTROL_COMMAND 0x80
+#define SH1106_CONTROL_DATA_STREAM 0x40
+
+// I2C address of a TCA9548A-style multiplexer with its address pins low, and the channel of a device on the main bus
+#define DEFAULT_MUX_ADDRESS 0x70
+#define NO_MUX_CHANNEL 0xFF
+
+// Largest number of command bytes a command stream can hold
+#ifndef SH1106_COMMAND_STREAM_SIZE
+#define SH1106_COMMAND_STREAM_SIZE 32
+#endif
+
+/*!
+    @brief  Collects a sequence of SH1106 commands so they can be sent to the controller together in one transaction.
+            Holds the command and argument bytes only; the transport adds whatever control bytes its bus needs.
+*/
+class SH1106_CommandStream {
+    public:
+        SH1106_CommandStream();
+
+        bool add(uint8_t command);
+        bool add(uint8_t command, uint8_t argument);
+        bool addProgmem(const uint8_t *commands, uint8_t count);
+        void clear();
+        const uint8_t *getCommands() const;
+        uint8_t getLength() const;
+
+    private:
+        uint8_t commands[SH1106_COMMAND_STREAM_SIZE];
+        uint8_t length;
+};
+
+
+/*!
+    @brief  Bus interface between SH1106_OLED and the controller.
+            sendCommands() sends a sequence of command bytes. sendData() sets the page and column address and writes display
+            data from there, sending as much of it as the bus allows in one transaction and returning how much was sent.
+            Transports that transfer in the background report isBusy() until the last transfer has finished, and the driver
+            waits for that before sending anything else.
+*/
+class SH1106_Transport {
+    public:
+        SH1106_Transport();
+        virtual ~SH1106_Transport() {}
+
+        virtual void begin() = 0;
+        virtual void sendCommands(const uint8_t *commands, uint8_t count) = 0;
+        virtual uint16_t sendData(uint8_t page, uint8_t column, const uint8_t *data, uint16_t count) = 0;
+        virtual bool isBusy();
+        uint32_t getBytesSent();
+        uint32_t getTransactionCount();
+
+    protected:
+        uint32_t bytesSent;
+        uint32_t transactions;
+};
+
+
+class SH1106_I2C : public SH1106_Transport {
+    public:
+        SH1106_I2C(uint8_t address, TwoWire &wire = Wire, uint32_t clock = 400000);
+
+        virtual void begin();
+        virtual void sendCommands(const uint8_t *commands, uint8_t count);
+        virtual uint16_t sendData(uint8_t page, uint8_t column, const uint8_t *data, uint16_t count);
+
+    private:
+        TwoWire &wire;
+        uint8_t address;
+        uint32_t clock;
+        uint8_t nextPage;
+        uint8_t nextColumn;
+};
+
+
+class SH1106_SPI : public SH1106_Transport {
+    public:
+        SH1106_SPI(uint8_t dcPin, uint8_t csPin, SPIClass &spi = SPI, uint32_t clock = SH1106_SPI_CLOCK);
+
+        virtual void begin();
+        virtual void sendCommands(const uint8_t *commands, uint8_t count);
+        virtual uint16_t sendData(uint8_t page, uint8_t column, const uint8_t *data, uint16_t count);
+
+    private:
+        void writeBytes(const uint8_t *bytes, uint16_t count);
+
+        SPIClass &spi;
+        uint8_t dcPin;
+        uint8_t csPin;
+        uint32_t clock;
+};
+
+
+/*!
+    @brief  Base for transports that send display data in the background, for example by DMA.
+            A subclass starts a transfer in sendData() and calls startTransfer() before returning, then calls transferComplete()
+            from its completion interrupt or callback. The data must not be modified until then, which the driver ensures when
+            double buffering is enabled.
+*/
+class SH1106_AsyncTransport : public SH1106_Transport {
+    public:
+        SH1106_AsyncTransport();
+
+        virtual bool isBusy();
+        void transferComplete();
+
+    protected:
+        void startTransfer();
+
+    private:
+        volatile bool busy;
+};
+
+
+/*!
+    @brief  A TCA9548A-style I2C multiplexer shared by the displays behind it. Remembers the open channel, so the
+            multiplexer is only written when a different channel is needed.
+*/
+class SH1106_Mux {
+    public:
+        SH1106_Mux(uint8_t address = DEFAULT_MUX_ADDRESS, TwoWire &wire = Wire);
+
+        void select(uint8_t channel, SH1106_Transport *transport);
+        uint8_t getChannel();
+
+    private:
+        TwoWire &wire;
+        uint8_t address;
+        uint8_t channel;
+        SH1106_Transport *owner;
+};
+
+
+/*!
+    @brief  Transport for an SH1106 behind a multiplexer channel. Wraps the display's own transport and selects the
+            channel before every command and data transfer, so commands sent outside a display() reach the right panel.
+*/
+class SH1106_MuxTransport : public SH1106_Transport {
+    public:
+        SH1106_MuxTransport(SH1106_Mux *mux = NULL, uint8_t channel = NO_MUX_CHANNEL, SH1106_Transport *transport = NULL);
+
+        virtual void begin();
+        virtual void sendCommands(const uint8_t *commands, uint8_t count);
+        virtual uint16_t sendData(uint8_t page, uint8_t column, const uint8_t *data, uint16_t count);
+        virtual bool isBusy();
+
+    private:
+        void updateCounts();
+
+        SH1106_Mux *mux;
+        uint8_t channel;
+        SH1106_Transport *transport;
+};
+
+#endif
@@ -0,0 +1,240 @@
+#!/usr/bin/env python3
+"""Converts a BDF bitmap font into the packed Font format used by SH1106_OLED.
+
+Usage:
+    python3 bdf2font.py input.bdf name [--range FIRST-LAST ...] [--spacing N] > name.h
+
+The generated header defines PROGMEM glyph tables and a `const Font name`
+that can be passed to SH1106_OLED::setFont(). Glyphs are proportional: each
+is trimmed to its advance width, and its columns are packed into
+(height + 7) / 8 page bytes with the top row in bit 0. Code points are
+grouped into contiguous ranges so sparse character sets stay compact, and
+an index table maps each 8-bit character straight to its glyph, with the
+uppercase and space fallbacks already applied.
+
+Run this as a build step whenever a font changes and commit or include the
+generated header alongside the sketch.
+"""
+
+import argparse
+import sys
+
+
+def parse_bdf(path):
+    """Returns (ascent, descent, glyphs), glyphs mapping code point to (advance, bbx, rows)."""
+    ascent = descent = None
+    bounding_box = None
+    glyphs = {}
+
+    with open(path, encoding="latin-1") as f:
+        lines = iter(f.read().splitlines())
+
+    for line in lines:
+        fields = line.split()
+        if not fields:
+            continue
+
+        keyword = fields[0]
+        if keyword == "FONTBOUNDINGBOX":
+            bounding_box = [int(v) for v in fields[1:5]]
+        elif keyword == "FONT_ASCENT":
+            ascent = int(fields[1])
+        elif keyword == "FONT_DESCENT":
+            descent = int(fields[1])
+        elif keyword == "STARTCHAR":
+            encoding = -1
+            advance = None
+            bbx = bounding_box
+            rows = []
+            for line in lines:
+                fields = line.split()
+                if not fields:
+                    continue
+
+                if fields[0] == "ENCODING":
+                    encoding = int(fields[1])
+                elif fields[0] == "DWIDTH":
+                    advance = int(fields[1])
+                elif fields[0] == "BBX":
+                    bbx = [int(v) for v in fields[1:5]]
+                elif fields[0] == "BITMAP":
+                    for line in lines:
+                        if line.strip() == "ENDCHAR":
+                            break
+                        rows.append(line.strip())
+                    break
+
+            if encoding >= 0:
+                if advance is None:
+                    advance = bbx[0] + bbx[2]
+                glyphs[encoding] = (advance, bbx, rows)
+
+    if ascent is None or descent is None:
+        ascent = bounding_box[1] + bounding_box[3]
+        descent = -bounding_box[3]
+
+    return ascent, descent, glyphs
+
+
+def render_glyph(advance, bbx, rows, ascent, height):
+    """Returns the glyph as a list of columns, each a list of page bytes."""
+    width, glyph_height, x_offset, y_offset = bbx
+    pixels = [[0] * advance for _ in range(height)]
+
+    top = ascent - (y_offset + glyph_height)
+    for row_index, row in enumerate(rows[:glyph_height]):
+        value = int(row, 16) if row else 0
+        bits = len(row) * 4
+        for col in range(width):
+            if value & (1 << (bits - 1 - col)):
+                x = x_offset + col
+                y = top + row_index
+                if 0 <= x < advance and 0 <= y < height:
+                    pixels[y][x] = 1
+
+    pages = (height + 7) // 8
+    columns = []
+    for x in range(advance):
+        column = []
+        for page in range(pages):
+            byte = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < height and pixels[y][x]:
+                    byte |= 1 << bit
+            column.append(byte)
+        columns.append(column)
+
+    return columns
+
+
+def group_ranges(codes):
+    ranges = []
+    for code in codes:
+        if ranges and code == ranges[-1][1] + 1:
+            ranges[-1][1] = code
+        else:
+            ranges.append([code, code])
+    return ranges
+
+
+def build_index(codes):
+    """Returns (first, entries) for the 8-bit character index, or None if it needs more than 255 entries or a glyph index past 254.
+
+    Each entry is the glyph index + 1 of the character, or of its uppercase form
+    or the space if the font lacks it, and 0 if none of these exist. Characters
+    outside the index take the space's entry, so matching entries are trimmed.
+    """
+    glyph_of = {code: i for i, code in enumerate(codes)}
+
+    def entry(code):
+        for fallback in (code, code - 32 if ord("a") <= code <= ord("z") else code, 32):
+            if fallback in glyph_of:
+                return glyph_of[fallback] + 1
+        return 0
+
+    entries = [entry(code) for code in range(256)]
+    if max(entries) > 255:
+        return None
+
+    space = entries[32]
+    wanted = [code for code in range(256) if entries[code] != space]
+    first = min(wanted + [32])
+    last = max(wanted + [32])
+    if last - first + 1 > 255:
+        return None
+    return first, entries[first:last + 1]
+
+
+def parse_range(text):
+    first, _, last = text.partition("-")
+    first = int(first, 0)
+    return first, int(last, 0) if last else first
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a BDF font to an SH1106_OLED packed font header.")
+    parser.add_argument("bdf", help="input BDF file")
+    parser.add_argument("name", help="C identifier for the generated Font")
+    parser.add_argument("--range", action="append", type=parse_range, default=[],
+                        help="code point range to include, e.g. 32-126 (default: 32-255)")
+    parser.add_argument("--spacing", type=int, default=0,
+                        help="blank columns added between glyphs (default: 0, BDF advances include spacing)")
+    args = parser.parse_args()
+
+    ascent, descent, glyphs = parse_bdf(args.bdf)
+    height = ascent + descent
+    if height > 64:
+        sys.exit("font height %d exceeds the 64 pixel panel" % height)
+
+    wanted = args.range or [(32, 255)]
+    codes = sorted(c for c in glyphs if c <= 0xFFFF and any(first <= c <= last for first, last in wanted))
+    if not codes:
+        sys.exit("no glyphs in the requested ranges")
+
+    ranges = group_ranges(codes)
+    if len(ranges) > 255:
+        sys.exit("too many code point ranges (%d), narrow --range" % len(ranges))
+
+    widths = []
+    offsets = []
+    data = []
+    for code in codes:
+        advance, bbx, rows = glyphs[code]
+        columns = render_glyph(advance, bbx, rows, ascent, height)
+        if len(columns) > 255:
+            sys.exit("glyph %d is wider than 255 pixels" % code)
+        widths.append(len(columns))
+        offsets.append(len(data))
+        for column in columns:
+            data.extend(column)
+
+    if len(data) > 0xFFFF:
+        sys.exit("font data exceeds 64 KB")
+
+    name = args.name
+    out = sys.stdout
+    out.write("// Generated by extras/bdf2font.py from %s - do not edit\n" % args.bdf.split("/")[-1])
+    out.write("#include <SH1106_OLED.h>\n\n")
+
+    out.write("const FontRange %s_ranges[] PROGMEM = {\n" % name)
+    index = 0
+    for first, last in ranges:
+        out.write("    { %d, %d, %d },\n" % (first, last, index))
+        index += last - first + 1
+    out.write("};\n\n")
+
+    out.write("const uint8_t %s_widths[] PROGMEM = {\n" % name)
+    for i in range(0, len(widths), 16):
+        out.write("    " + ", ".join("%d" % w for w in widths[i:i + 16]) + ",\n")
+    out.write("};\n\n")
+
+    out.write("const uint16_t %s_offsets[] PROGMEM = {\n" % name)
+    for i in range(0, len(offsets), 12):
+        out.write("    " + ", ".join("%d" % o for o in offsets[i:i + 12]) + ",\n")
+    out.write("};\n\n")
+
+    out.write("const uint8_t %s_bitmaps[] PROGMEM = {\n" % name)
+    for i in range(0, len(data), 16):
+        out.write("    " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",\n")
+    out.write("};\n\n")
+
+    character_index = build_index(codes)
+    if character_index is None:
+        sys.stderr.write("the character index does not fit in bytes, so glyphs will be found by searching ranges\n")
+        out.write("const Font %s = { %d, %d, 0, %d, %s_ranges, %s_widths, %s_offsets, %s_bitmaps, 0, 0, NULL };\n"
+                  % (name, height, args.spacing, len(ranges), name, name, name, name))
+        return
+
+    index_first, entries = character_index
+    out.write("const uint8_t %s_index[] PROGMEM = {\n" % name)
+    for i in range(0, len(entries), 16):
+        out.write("    " + ", ".join("%d" % e for e in entries[i:i + 16]) + ",\n")
+    out.write("};\n\n")
+
+    out.write("const Font %s = { %d, %d, 0, %d, %s_ranges, %s_widths, %s_offsets, %s_bitmaps, %d, %d, %s_index };\n"
+              % (name, height, args.spacing, len(ranges), name, name, name, name, index_first, len(entries), name))
+
+
+if __name__ == "__main__":
+    main()
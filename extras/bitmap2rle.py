@@ -0,0 +1,198 @@
+#!/usr/bin/env python3
+"""Compresses a 1-bit image into the run-length format read by SH1106_OLED::drawCompressedBitmap().
+
+Usage:
+    python3 bitmap2rle.py input.pbm name [--invert] > name.h
+
+Input is a PBM image (P1 or P4). Other formats are accepted when Pillow is
+installed. Every format has the same polarity: light pixels are lit, so a
+PBM 0 (white) bit is lit and a 1 (black) bit is not. --invert lights the
+dark pixels instead, whatever the format. The image is packed into pages of
+8 rows, top row in bit 0, exactly as drawBitmap() expects, and then
+compressed:
+
+    width, height,
+    0x00-0x7F   copy the next (n + 1) bytes
+    0x80-0xBF   repeat the next byte ((n & 0x3F) + 2) times
+    0xC0-0xDF   ((n & 0x1F) + 1) bytes of 0x00
+    0xE0-0xFF   ((n & 0x1F) + 1) bytes of 0xFF
+
+Blank and solid areas, which dominate typical UI bitmaps, cost one byte per
+32 columns. The compression ratio is reported on stderr.
+"""
+
+import argparse
+import sys
+
+LITERAL_MAX = 128
+REPEAT_MAX = 65
+FILL_MAX = 32
+
+
+def read_pbm_tokens(data):
+    """Yields whitespace separated header tokens, skipping comments, and the offset after each."""
+    i = 0
+    while True:
+        while i < len(data) and data[i:i + 1].isspace():
+            i += 1
+        if data[i:i + 1] == b"#":
+            while i < len(data) and data[i:i + 1] != b"\n":
+                i += 1
+            continue
+        start = i
+        while i < len(data) and not data[i:i + 1].isspace():
+            i += 1
+        yield data[start:i], i
+
+
+def load_pbm(path):
+    """Returns (width, height, rows) with 1 for lit pixels. PBM stores 1 for black, so bits are inverted."""
+    with open(path, "rb") as f:
+        data = f.read()
+
+    tokens = read_pbm_tokens(data)
+    magic, _ = next(tokens)
+    width = int(next(tokens)[0])
+    height, end = next(tokens)
+    height = int(height)
+
+    if magic == b"P4":
+        raster = data[end + 1:]
+        stride = (width + 7) // 8
+        return width, height, [[1 - ((raster[y * stride + x // 8] >> (7 - x % 8)) & 1) for x in range(width)]
+                               for y in range(height)]
+
+    if magic == b"P1":
+        bits = [1 - (c - ord("0")) for c in data[end:] if c in b"01"]
+        return width, height, [bits[y * width:(y + 1) * width] for y in range(height)]
+
+    raise ValueError("not a P1 or P4 PBM file")
+
+
+def load_image(path):
+    """Returns (width, height, rows) with 1 for lit pixels."""
+    try:
+        return load_pbm(path)
+    except (ValueError, StopIteration):
+        pass
+
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit("%s is not a PBM file and Pillow is not installed" % path)
+
+    # Light pixels are lit, matching the PBM path
+    image = Image.open(path).convert("L")
+    width, height = image.size
+    pixels = image.load()
+    return width, height, [[1 if pixels[x, y] >= 128 else 0 for x in range(width)] for y in range(height)]
+
+
+def pack_pages(width, height, rows):
+    """Packs rows into page-major column bytes as used by drawBitmap()."""
+    packed = []
+    for page in range((height + 7) // 8):
+        for x in range(width):
+            byte = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < height and rows[y][x]:
+                    byte |= 1 << bit
+            packed.append(byte)
+    return packed
+
+
+def run_length(data, i):
+    n = 1
+    while i + n < len(data) and data[i + n] == data[i]:
+        n += 1
+    return n
+
+
+def compress(data):
+    out = []
+    literal = []
+
+    def flush_literal():
+        while literal:
+            chunk = literal[:LITERAL_MAX]
+            del literal[:LITERAL_MAX]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+
+    i = 0
+    while i < len(data):
+        value = data[i]
+        n = run_length(data, i)
+        if value in (0x00, 0xFF):
+            # Fills have no data byte, so even a single byte is no worse than a literal
+            if n >= 2 or not literal:
+                flush_literal()
+                n = min(n, FILL_MAX)
+                out.append((0xE0 if value else 0xC0) | (n - 1))
+                i += n
+                continue
+        elif n >= 3 or (n == 2 and not literal):
+            flush_literal()
+            n = min(n, REPEAT_MAX)
+            out.extend([0x80 | (n - 2), value])
+            i += n
+            continue
+
+        literal.append(value)
+        i += 1
+
+    flush_literal()
+    return out
+
+
+def decompress(stream, size):
+    out = []
+    i = 0
+    while len(out) < size:
+        control = stream[i]
+        i += 1
+        if control < 0x80:
+            out.extend(stream[i:i + control + 1])
+            i += control + 1
+        elif control < 0xC0:
+            out.extend([stream[i]] * ((control & 0x3F) + 2))
+            i += 1
+        else:
+            out.extend([0xFF if control & 0x20 else 0x00] * ((control & 0x1F) + 1))
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compress a 1-bit image for SH1106_OLED::drawCompressedBitmap().")
+    parser.add_argument("image", help="input image, PBM or any format Pillow can read")
+    parser.add_argument("name", help="C identifier for the generated array")
+    parser.add_argument("--invert", action="store_true", help="light the dark pixels instead")
+    args = parser.parse_args()
+
+    width, height, rows = load_image(args.image)
+    if not 0 < width <= 255 or not 0 < height <= 255:
+        sys.exit("image must be between 1x1 and 255x255 pixels, not %dx%d" % (width, height))
+
+    if args.invert:
+        rows = [[1 - p for p in row] for row in rows]
+
+    raw = pack_pages(width, height, rows)
+    stream = compress(raw)
+    assert decompress(stream, len(raw)) == raw
+
+    encoded = [width, height] + stream
+    sys.stderr.write("%s: %d bytes raw, %d bytes compressed (%.1f%%)\n"
+                     % (args.name, len(raw), len(encoded), 100.0 * len(encoded) / len(raw)))
+
+    out = sys.stdout
+    out.write("// Generated by extras/bitmap2rle.py from %s - do not edit\n" % args.image.split("/")[-1])
+    out.write("#include <SH1106_OLED.h>\n\n")
+    out.write("const uint8_t %s[] PROGMEM = {\n" % args.name)
+    for i in range(0, len(encoded), 16):
+        out.write("    " + ", ".join("0x%02X" % b for b in encoded[i:i + 16]) + ",\n")
+    out.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,226 @@
+#include "SH1106_Model.h"
+
+/*!
+    @brief  Instantiates a model of an SH1106 driving a panel of the given geometry, in its power-on reset state.
+    @param  width           Panel width in pixels
+    @param  height          Panel height in pixels, wired to the first height COM lines
+    @param  columnOffset    First RAM column wired to the panel, counted from the end the driver writes from in normal orientation
+*/
+SH1106_Model::SH1106_Model(uint8_t width, uint8_t height, uint8_t columnOffset) : width(width), height(height), columnOffset(columnOffset), wireRead(0), spiRead(0) {
+    reset();
+}
+
+
+/*!
+    @brief  Returns the controller to its power-on state. RAM contents are undefined after reset, so they are filled
+            with a pattern the driver never draws by accident, making unwritten bytes easy to spot.
+*/
+void SH1106_Model::reset() {
+    memset(ram, 0xA5, sizeof(ram));
+    page = 0;
+    column = 0;
+    startLine = 0;
+    displayOffset = 0;
+    multiplex = MODEL_ROWS - 1;
+    contrast = 0x80;
+    inverse = false;
+    on = false;
+    segmentRemap = false;
+    comRemap = false;
+    chargePump = true;
+    transactions = 0;
+    busBytes = 0;
+    commandBytes = 0;
+    dataBytes = 0;
+    overflowBytes = 0;
+    argumentFor = 0;
+}
+
+
+/*!
+    @brief  Decodes the bytes of one I2C transaction, after the address byte. Each control byte with Co set applies to
+            the single byte after it; a control byte with Co clear applies to every remaining byte in the transaction.
+    @param  bytes   Transaction bytes
+    @param  count   Number of bytes
+*/
+void SH1106_Model::receive(const uint8_t *bytes, size_t count) {
+    transactions++;
+    busBytes += count + 1;
+
+    size_t i = 0;
+    while (i < count) {
+        uint8_t control = bytes[i++];
+        bool continuation = control & 0x80;
+        bool isData = control & 0x40;
+        size_t end = continuation ? min(i + 1, count) : count;
+        for (; i < end; i++) {
+            if (isData) {
+                data(bytes[i]);
+            } else {
+                command(bytes[i]);
+            }
+        }
+    }
+}
+
+
+/*!
+    @brief  Decodes every transaction to the given address logged on a Wire bus since the last call.
+    @param  wire    Bus to read the log of
+    @param  address I2C address of the modelled controller
+*/
+void SH1106_Model::receive(const TwoWire &wire, uint8_t address) {
+    const std::vector<WireTransaction> &log = wire.getLog();
+    if (wireRead > log.size()) {
+        wireRead = 0;
+    }
+
+    for (; wireRead < log.size(); wireRead++) {
+        if (log[wireRead].address == address) {
+            receive(log[wireRead].bytes.data(), log[wireRead].bytes.size());
+        }
+    }
+}
+
+
+/*!
+    @brief  Decodes every byte logged on an SPI bus since the last call. Chip select cycles are not tracked, so
+            transactions and busBytes count bytes rather than cycles.
+    @param  spi     Bus to read the log of
+*/
+void SH1106_Model::receive(const SPIClass &spi) {
+    const std::vector<SPIByte> &log = spi.getLog();
+    if (spiRead > log.size()) {
+        spiRead = 0;
+    }
+
+    for (; spiRead < log.size(); spiRead++) {
+        busBytes++;
+        if (log[spiRead].data) {
+            data(log[spiRead].value);
+        } else {
+            command(log[spiRead].value);
+        }
+    }
+}
+
+
+/*!
+    @brief  Executes a command byte, or stores it as the argument of the preceding two byte command.
+    @param  value   Command byte
+*/
+void SH1106_Model::command(uint8_t value) {
+    commandBytes++;
+
+    if (argumentFor) {
+        switch (argumentFor) {
+            case 0x81: contrast = value; break;
+            case 0xA8: multiplex = value & 0x3F; break;
+            case 0xAD: chargePump = value & 0x01; break;
+            case 0xD3: displayOffset = value & 0x3F; break;
+        }
+
+        argumentFor = 0;
+        return;
+    }
+
+    if (value <= 0x0F) {
+        column = (column & 0xF0) | value;
+    } else if (value <= 0x1F) {
+        column = (column & 0x0F) | ((value & 0x0F) << 4);
+    } else if (value >= 0x40 && value <= 0x7F) {
+        startLine = value & 0x3F;
+    } else if (value >= 0xB0 && value <= 0xB7) {
+        page = value & 0x07;
+    } else {
+        switch (value) {
+            case 0x81: case 0xA8: case 0xAD: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+                argumentFor = value;
+                break;
+            case 0xA0: segmentRemap = false; break;
+            case 0xA1: segmentRemap = true; break;
+            case 0xA6: inverse = false; break;
+            case 0xA7: inverse = true; break;
+            case 0xAE: on = false; break;
+            case 0xAF: on = true; break;
+            case 0xC0: comRemap = false; break;
+            case 0xC8: comRemap = true; break;
+        }
+    }
+}
+
+
+/*!
+    @brief  Writes a display data byte at the current page and column, then advances the column.
+            The SH1106 column counter stops at the last RAM column, so bytes beyond it are counted as overflow.
+    @param  value   Display data byte
+*/
+void SH1106_Model::data(uint8_t value) {
+    dataBytes++;
+
+    if (column >= MODEL_COLUMNS) {
+        overflowBytes++;
+        return;
+    }
+
+    ram[page][column++] = value;
+}
+
+
+/*!
+    @brief  Returns a byte of display RAM.
+    @param  page    RAM page
+    @param  column  RAM column
+    @returns Display data byte
+*/
+uint8_t SH1106_Model::getRam(uint8_t page, uint8_t column) const {
+    return ram[page % MODEL_PAGES][column % MODEL_COLUMNS];
+}
+
+
+/*!
+    @brief  Returns a pixel of display RAM.
+    @param  column  RAM column
+    @param  row     RAM row, 0 to 63
+    @returns Boolean true if the bit is set
+*/
+bool SH1106_Model::getRamPixel(uint8_t column, uint8_t row) const {
+    return (getRam(row / 8, column) >> (row & 0x07)) & 0x01;
+}
+
+
+/*!
+    @brief  Returns the RAM row shown on a panel row. The COM scan direction picks which of the multiplexed rows the
+            panel row shows, and the start line and display offset then move that into RAM, wrapping at 64 rows.
+    @param  y   Panel row
+    @returns RAM row
+*/
+uint8_t SH1106_Model::getPanelRow(uint8_t y) const {
+    uint8_t scanRow = comRemap ? y : multiplex - y;
+    return (scanRow + startLine + displayOffset) % MODEL_ROWS;
+}
+
+
+/*!
+    @brief  Returns the RAM column shown on a panel column, taking the segment re-map into account.
+    @param  x   Panel column
+    @returns RAM column
+*/
+uint8_t SH1106_Model::getPanelColumn(uint8_t x) const {
+    return segmentRemap ? columnOffset + x : MODEL_COLUMNS - 1 - columnOffset - x;
+}
+
+
+/*!
+    @brief  Returns whether a panel pixel is lit, including the effect of display off and inverse display.
+    @param  x   Panel column
+    @param  y   Panel row
+    @returns Boolean true if the pixel emits light
+*/
+bool SH1106_Model::getPanelPixel(uint8_t x, uint8_t y) const {
+    if (!on) {
+        return false;
+    }
+
+    return getRamPixel(getPanelColumn(x), getPanelRow(y)) != inverse;
+}
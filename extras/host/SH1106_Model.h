@@ -0,0 +1,65 @@
+#ifndef SH1106_Model_h
+#define SH1106_Model_h
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <SPI.h>
+
+#define MODEL_COLUMNS 132
+#define MODEL_PAGES 8
+#define MODEL_ROWS 64
+
+/*!
+    @brief  Software model of an SH1106 controller and the panel wired to it, for checking the driver on the host.
+            Decodes the I2C control byte framing (0x00 command stream, 0x80 single command, 0x40 data stream) or SPI
+            data/command bytes into the 132 x 8 page display RAM and the registers that affect what the panel shows.
+            The panel is assumed wired the way SH1106_OLED expects in ORIENTATION_NORMAL: panel column x on RAM column
+            columnOffset + x after the segment re-map, and panel row y on the COM line that shows RAM row y after the COM re-map.
+*/
+class SH1106_Model {
+    public:
+        SH1106_Model(uint8_t width = 128, uint8_t height = 64, uint8_t columnOffset = 2);
+
+        void reset();
+        void receive(const uint8_t *bytes, size_t count);
+        void receive(const TwoWire &wire, uint8_t address = 0x3C);
+        void receive(const SPIClass &spi);
+        void command(uint8_t value);
+        void data(uint8_t value);
+
+        uint8_t getRam(uint8_t page, uint8_t column) const;
+        bool getRamPixel(uint8_t column, uint8_t row) const;
+        uint8_t getPanelRow(uint8_t y) const;
+        uint8_t getPanelColumn(uint8_t x) const;
+        bool getPanelPixel(uint8_t x, uint8_t y) const;
+
+        uint8_t width;
+        uint8_t height;
+        uint8_t columnOffset;
+
+        uint8_t page;
+        uint8_t column;
+        uint8_t startLine;
+        uint8_t displayOffset;
+        uint8_t multiplex;
+        uint8_t contrast;
+        bool inverse;
+        bool on;
+        bool segmentRemap;
+        bool comRemap;
+        bool chargePump;
+
+        uint32_t transactions;
+        uint32_t busBytes;
+        uint32_t commandBytes;
+        uint32_t dataBytes;
+        uint32_t overflowBytes;
+
+    private:
+        uint8_t ram[MODEL_PAGES][MODEL_COLUMNS];
+        uint8_t argumentFor;
+        size_t wireRead;
+        size_t spiRead;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include "SH1106_RecordingTransport.h"
+
+/*!
+    @brief  Instantiates a recording transport.
+    @param  chunkSize   Most bytes sendData() accepts per call, or 0 to always accept everything
+*/
+SH1106_RecordingTransport::SH1106_RecordingTransport(uint16_t chunkSize) : beginCount(0), chunkSize(chunkSize), replayed(0) {}
+
+
+void SH1106_RecordingTransport::begin() {
+    beginCount++;
+}
+
+
+/*!
+    @brief  Records a command stream.
+    @param  commands    Command bytes, including any argument bytes
+    @param  count       Number of bytes
+*/
+void SH1106_RecordingTransport::sendCommands(const uint8_t *commands, uint8_t count) {
+    TransportRecord record = { false, 0, 0, std::vector<uint8_t>(commands, commands + count) };
+    records.push_back(record);
+    bytesSent += count;
+    transactions++;
+}
+
+
+/*!
+    @brief  Records a data write, accepting up to chunkSize bytes of it.
+    @param  page    Page to write
+    @param  column  RAM column to start at
+    @param  data    Display data
+    @param  count   Number of bytes remaining to write
+    @returns Number of bytes recorded
+*/
+uint16_t SH1106_RecordingTransport::sendData(uint8_t page, uint8_t column, const uint8_t *data, uint16_t count) {
+    if (chunkSize && count > chunkSize) {
+        count = chunkSize;
+    }
+
+    TransportRecord record = { true, page, column, std::vector<uint8_t>(data, data + count) };
+    records.push_back(record);
+    bytesSent += count;
+    transactions++;
+    return count;
+}
+
+
+/*!
+    @brief  Applies the records made since the last replay to a controller model, as a bus would deliver them.
+    @param  model   Model to update
+*/
+void SH1106_RecordingTransport::replay(SH1106_Model &model) {
+    for (; replayed < records.size(); replayed++) {
+        const TransportRecord &record = records[replayed];
+        model.transactions++;
+        if (record.isData) {
+            model.command(0xB0 + record.page);
+            model.command(0x10 | (record.column >> 4));
+            model.command(record.column & 0x0F);
+        }
+
+        for (size_t i = 0; i < record.bytes.size(); i++) {
+            if (record.isData) {
+                model.data(record.bytes[i]);
+            } else {
+                model.command(record.bytes[i]);
+            }
+        }
+    }
+}
+
+
+/*!
+    @brief  Discards the records.
+*/
+void SH1106_RecordingTransport::clear() {
+    records.clear();
+    replayed = 0;
+}
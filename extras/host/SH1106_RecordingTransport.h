@@ -0,0 +1,38 @@
+#ifndef SH1106_RecordingTransport_h
+#define SH1106_RecordingTransport_h
+
+#include <vector>
+#include "SH1106_Transport.h"
+#include "SH1106_Model.h"
+
+struct TransportRecord {
+    bool isData;
+    uint8_t page;
+    uint8_t column;
+    std::vector<uint8_t> bytes;
+};
+
+/*!
+    @brief  Fake transport for host tests that records each sendCommands() and sendData() call instead of driving a bus.
+            A chunk size can be set to make sendData() accept only part of the data per call, like a bus with a small buffer.
+*/
+class SH1106_RecordingTransport : public SH1106_Transport {
+    public:
+        SH1106_RecordingTransport(uint16_t chunkSize = 0);
+
+        virtual void begin();
+        virtual void sendCommands(const uint8_t *commands, uint8_t count);
+        virtual uint16_t sendData(uint8_t page, uint8_t column, const uint8_t *data, uint16_t count);
+
+        void replay(SH1106_Model &model);
+        void clear();
+
+        std::vector<TransportRecord> records;
+        uint32_t beginCount;
+        uint16_t chunkSize;
+
+    private:
+        size_t replayed;
+};
+
+#endif
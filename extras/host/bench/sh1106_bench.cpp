@@ -0,0 +1,218 @@
+// Benchmarks each drawing primitive and display() on the host build. See extras/host/README.md for the output format.
+//
+//   sh1106_bench [--format csv|json] [--min-time ms]
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include "SH1106_OLED.h"
+
+struct BenchCase {
+    const char *primitive;
+    const char *size;
+    const char *position;
+    std::function<void(SH1106_OLED &)> call;
+};
+
+struct BenchResult {
+    const BenchCase *benchCase;
+    double nsPerCall;
+    uint32_t bytesTouched;
+    uint32_t i2cBytes;
+    uint32_t i2cTransactions;
+};
+
+static const uint8_t sprite16[32] = {
+    0xFF, 0x01, 0x05, 0x09, 0x11, 0x21, 0x41, 0x81, 0x81, 0x41, 0x21, 0x11, 0x09, 0x05, 0x01, 0xFF,
+    0xFF, 0x80, 0xA0, 0x90, 0x88, 0x84, 0x82, 0x81, 0x81, 0x82, 0x84, 0x88, 0x90, 0xA0, 0x80, 0xFF
+};
+
+static uint8_t fullScreen[128 * 64 / 8];
+
+
+static std::vector<BenchCase> getCases() {
+    std::vector<BenchCase> cases;
+
+    cases.push_back({ "setPixel", "1", "centre", [](SH1106_OLED &oled) { oled.setPixel(64, 32); } });
+    cases.push_back({ "setPixel", "1", "offscreen", [](SH1106_OLED &oled) { oled.setPixel(200, 32); } });
+
+    cases.push_back({ "drawLine", "8", "centre", [](SH1106_OLED &oled) { oled.drawLine(60, 28, 67, 35); } });
+    cases.push_back({ "drawLine", "64", "centre", [](SH1106_OLED &oled) { oled.drawLine(32, 0, 95, 63); } });
+    cases.push_back({ "drawLine", "128", "horizontal", [](SH1106_OLED &oled) { oled.drawLine(0, 31, 127, 31); } });
+    cases.push_back({ "drawLine", "64", "vertical", [](SH1106_OLED &oled) { oled.drawLine(64, 0, 64, 63); } });
+    cases.push_back({ "drawLine", "200", "clipped", [](SH1106_OLED &oled) { oled.drawLine(0, 0, 255, 200); } });
+
+    static const uint8_t radii[] = { 4, 16, 31 };
+    static const char *radiusNames[] = { "r4", "r16", "r31" };
+    for (uint8_t i = 0; i < 3; i++) {
+        uint8_t r = radii[i];
+        cases.push_back({ "drawCircle", radiusNames[i], "centre", [r](SH1106_OLED &oled) { oled.drawCircle(64, 32, r); } });
+        cases.push_back({ "drawCircleFill", radiusNames[i], "centre", [r](SH1106_OLED &oled) { oled.drawCircleFill(64, 32, r); } });
+        cases.push_back({ "drawArcRaw", radiusNames[i], "centre", [r](SH1106_OLED &oled) { oled.drawArcRaw(64, 32, r, 30, 240); } });
+    }
+    cases.push_back({ "drawCircle", "r16", "edge", [](SH1106_OLED &oled) { oled.drawCircle(124, 60, 16); } });
+    cases.push_back({ "drawCircleFill", "r16", "edge", [](SH1106_OLED &oled) { oled.drawCircleFill(124, 60, 16); } });
+
+    cases.push_back({ "drawRoundedRect", "16x8", "centre", [](SH1106_OLED &oled) { oled.drawRoundedRect(56, 28, 16, 8, 3); } });
+    cases.push_back({ "drawRoundedRect", "120x56", "centre", [](SH1106_OLED &oled) { oled.drawRoundedRect(4, 4, 120, 56, 8); } });
+    cases.push_back({ "drawRoundedRectFill", "16x8", "centre", [](SH1106_OLED &oled) { oled.drawRoundedRectFill(56, 28, 16, 8, 3); } });
+    cases.push_back({ "drawRoundedRectFill", "120x56", "centre", [](SH1106_OLED &oled) { oled.drawRoundedRectFill(4, 4, 120, 56, 8); } });
+    cases.push_back({ "drawRoundedRectFill", "120x56", "edge", [](SH1106_OLED &oled) { oled.drawRoundedRectFill(60, 30, 120, 56, 8); } });
+
+    cases.push_back({ "drawTriangleFill", "small", "centre", [](SH1106_OLED &oled) { oled.drawTriangleFill(60, 28, 70, 30, 64, 38); } });
+    cases.push_back({ "drawTriangleFill", "large", "centre", [](SH1106_OLED &oled) { oled.drawTriangleFill(2, 2, 125, 20, 40, 61); } });
+
+    cases.push_back({ "print", "1 char", "origin", [](SH1106_OLED &oled) { oled.print("A", 0, 0); } });
+    cases.push_back({ "print", "20 chars", "unaligned", [](SH1106_OLED &oled) { oled.print("THE QUICK BROWN FOX!", 1, 3); } });
+    cases.push_back({ "print", "20 chars x2", "unaligned", [](SH1106_OLED &oled) {
+        oled.setTextScale(2);
+        oled.print("THE QUICK BROWN FOX!", 1, 3);
+        oled.setTextScale(1);
+    } });
+
+    cases.push_back({ "drawBitmap", "16x16", "aligned", [](SH1106_OLED &oled) { oled.drawBitmap(sprite16, 32, 16, 16, 16, BITMAP_OR, false); } });
+    cases.push_back({ "drawBitmap", "16x16", "unaligned", [](SH1106_OLED &oled) { oled.drawBitmap(sprite16, 33, 13, 16, 16, BITMAP_OR, false); } });
+    cases.push_back({ "drawBitmap", "16x16", "clipped", [](SH1106_OLED &oled) { oled.drawBitmap(sprite16, 120, 58, 16, 16, BITMAP_OR, false); } });
+    cases.push_back({ "drawBitmap", "128x64", "aligned", [](SH1106_OLED &oled) { oled.drawBitmap(fullScreen, 0, 0, 128, 64, BITMAP_COPY, false); } });
+
+    return cases;
+}
+
+
+// Times fn, repeating it until at least minNanos have passed so short calls are not lost in clock resolution
+static double timeCall(const std::function<void()> &fn, uint64_t minNanos) {
+    uint32_t iterations = 1;
+    while (true) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            fn();
+        }
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= minNanos || iterations >= (1u << 26)) {
+            return (double)elapsed / iterations;
+        }
+
+        iterations *= 2;
+    }
+}
+
+
+static BenchResult runCase(const BenchCase &benchCase, uint64_t minNanos) {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    oled.init();
+
+    BenchResult result;
+    result.benchCase = &benchCase;
+
+    // Cost of the drawing call into a clean buffer: bytes it marks for sending, and what display() then sends
+    oled.clear();
+    oled.display();
+    Wire.clearLog();
+    benchCase.call(oled);
+    result.bytesTouched = oled.getDirtyBytes();
+    uint32_t bytesBefore = oled.getBytesSent();
+    uint32_t transactionsBefore = oled.getTransactionCount();
+    oled.display();
+    result.i2cBytes = oled.getBytesSent() - bytesBefore;
+    result.i2cTransactions = oled.getTransactionCount() - transactionsBefore;
+
+    result.nsPerCall = timeCall([&]() { benchCase.call(oled); }, minNanos);
+    return result;
+}
+
+
+static BenchResult runDisplay(const BenchCase &benchCase, bool full, uint64_t minNanos) {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    oled.init();
+    oled.display();
+
+    BenchResult result;
+    result.benchCase = &benchCase;
+    uint32_t bytesBefore = oled.getBytesSent();
+    uint32_t transactionsBefore = oled.getTransactionCount();
+    benchCase.call(oled);
+    result.bytesTouched = oled.getDirtyBytes();
+    oled.display();
+    result.i2cBytes = oled.getBytesSent() - bytesBefore;
+    result.i2cTransactions = oled.getTransactionCount() - transactionsBefore;
+
+    // The Wire log is cleared every call so the host's memory use stays flat; that cost is part of the figure
+    result.nsPerCall = timeCall([&]() {
+        if (full) {
+            oled.invert();
+        } else {
+            oled.invertPixel(64, 32);
+        }
+        oled.display();
+        Wire.clearLog();
+    }, minNanos);
+    return result;
+}
+
+
+static void printCsv(const std::vector<BenchResult> &results) {
+    printf("primitive,size,position,ns_per_call,bytes_touched,i2c_bytes,i2c_transactions\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        printf("%s,%s,%s,%.1f,%u,%u,%u\n", r.benchCase->primitive, r.benchCase->size, r.benchCase->position, r.nsPerCall, r.bytesTouched, r.i2cBytes, r.i2cTransactions);
+    }
+}
+
+
+static void printJson(const std::vector<BenchResult> &results) {
+    printf("[\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        printf("  {\"primitive\": \"%s\", \"size\": \"%s\", \"position\": \"%s\", \"ns_per_call\": %.1f, \"bytes_touched\": %u, \"i2c_bytes\": %u, \"i2c_transactions\": %u}%s\n",
+            r.benchCase->primitive, r.benchCase->size, r.benchCase->position, r.nsPerCall, r.bytesTouched, r.i2cBytes, r.i2cTransactions, i + 1 < results.size() ? "," : "");
+    }
+    printf("]\n");
+}
+
+
+int main(int argc, char **argv) {
+    std::string format = "csv";
+    uint64_t minNanos = 20000000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            format = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            minNanos = strtoull(argv[++i], NULL, 10) * 1000000;
+        } else {
+            fprintf(stderr, "usage: %s [--format csv|json] [--min-time ms]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (format != "csv" && format != "json") {
+        fprintf(stderr, "unknown format %s\n", format.c_str());
+        return 2;
+    }
+
+    for (uint16_t i = 0; i < sizeof(fullScreen); i++) {
+        fullScreen[i] = (uint8_t)(i * 37);
+    }
+
+    std::vector<BenchCase> cases = getCases();
+    BenchCase displayFull = { "display", "full frame", "all pages", [](SH1106_OLED &oled) { oled.invert(); } };
+    BenchCase displayPixel = { "display", "1 pixel", "centre", [](SH1106_OLED &oled) { oled.invertPixel(64, 32); } };
+
+    std::vector<BenchResult> results;
+    for (size_t i = 0; i < cases.size(); i++) {
+        results.push_back(runCase(cases[i], minNanos));
+    }
+    results.push_back(runDisplay(displayFull, true, minNanos));
+    results.push_back(runDisplay(displayPixel, false, minNanos));
+
+    if (format == "json") {
+        printJson(results);
+    } else {
+        printCsv(results);
+    }
+
+    return 0;
+}
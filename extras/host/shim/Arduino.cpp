@@ -0,0 +1,156 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include <SPI.h>
+
+uint8_t hostPinLevels[HOST_PINS];
+uint64_t hostNanos = 0;
+
+TwoWire Wire;
+SPIClass SPI;
+
+
+/*!
+    @brief  Restarts the virtual clock at zero, as if the board had just been reset, and clears the bus logs.
+*/
+void hostReset() {
+    hostNanos = 0;
+    memset(hostPinLevels, 0, sizeof(hostPinLevels));
+    Wire.clearLog();
+    SPI.clearLog();
+}
+
+
+TwoWire::TwoWire() : clock(100000), busNanos(0), transmitting(false) {}
+
+
+void TwoWire::begin() {}
+
+
+void TwoWire::setClock(uint32_t frequency) {
+    clock = frequency;
+}
+
+
+void TwoWire::beginTransmission(uint8_t address) {
+    current.address = address;
+    current.bytes.clear();
+    transmitting = true;
+}
+
+
+/*!
+    @brief  Queues a byte for the current transmission. Like the AVR Wire library, bytes beyond BUFFER_LENGTH are dropped.
+    @param  value   Byte to queue
+    @returns Number of bytes queued, 0 if the buffer is full
+*/
+size_t TwoWire::write(uint8_t value) {
+    if (!transmitting || current.bytes.size() >= BUFFER_LENGTH) {
+        return 0;
+    }
+
+    current.bytes.push_back(value);
+    return 1;
+}
+
+
+size_t TwoWire::write(const uint8_t *values, size_t count) {
+    size_t written = 0;
+    while (count-- && write(*values++)) {
+        written++;
+    }
+
+    return written;
+}
+
+
+/*!
+    @brief  Completes the transmission. Bus time is 9 clocks per byte including the address byte, plus start and stop.
+    @param  sendStop    Ignored, every transmission is logged as complete
+    @returns 0 for success, like Wire
+*/
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    transmitting = false;
+    log.push_back(current);
+
+    uint64_t nanos = ((current.bytes.size() + 1) * 9 + 2) * 1000000000ULL / clock;
+    busNanos += nanos;
+    hostAdvanceNanos(nanos);
+    return 0;
+}
+
+
+uint32_t TwoWire::getClock() const {
+    return clock;
+}
+
+
+/*!
+    @brief  Returns the bus time of all transmissions since the log was last cleared.
+    @returns Microseconds of bus activity
+*/
+uint64_t TwoWire::getBusMicros() const {
+    return busNanos / 1000;
+}
+
+
+const std::vector<WireTransaction> &TwoWire::getLog() const {
+    return log;
+}
+
+
+void TwoWire::clearLog() {
+    log.clear();
+    busNanos = 0;
+}
+
+
+SPIClass::SPIClass() : dcPin(0xFF), csPin(0xFF), clock(4000000) {}
+
+
+void SPIClass::begin() {}
+
+
+void SPIClass::beginTransaction(SPISettings settings) {
+    clock = settings.clock;
+}
+
+
+void SPIClass::endTransaction() {}
+
+
+/*!
+    @brief  Clocks a byte out, logging it if the attached device is selected, and advances the virtual clock by 8 clocks.
+    @param  value   Byte to send
+    @returns Byte clocked in, always 0 on the host
+*/
+uint8_t SPIClass::transfer(uint8_t value) {
+    if (csPin != 0xFF && digitalRead(csPin) == LOW) {
+        SPIByte logged = { digitalRead(dcPin) == HIGH, value };
+        log.push_back(logged);
+    }
+
+    hostAdvanceNanos(8000000000ULL / clock);
+    return 0;
+}
+
+
+/*!
+    @brief  Sets the pins of the device whose traffic is logged.
+    @param  dcPin   Data/command pin
+    @param  csPin   Chip select pin
+*/
+void SPIClass::attach(uint8_t dcPin, uint8_t csPin) {
+    this->dcPin = dcPin;
+    this->csPin = csPin;
+}
+
+
+const std::vector<SPIByte> &SPIClass::getLog() const {
+    return log;
+}
+
+
+void SPIClass::clearLog() {
+    log.clear();
+}
@@ -0,0 +1,93 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+// Host stand-in for the parts of the Arduino core the library uses. Time is virtual: it only moves when delay() is
+// called or when a shimmed bus transfer takes time, so tests are deterministic and never sleep.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <avr/pgmspace.h>
+
+#define PROGMEM
+#define PI 3.1415926535897932384626433832795
+#define DEC 10
+#define HEX 16
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+using std::min;
+using std::max;
+
+// Host pins and virtual clock
+#define HOST_PINS 64
+
+extern uint8_t hostPinLevels[HOST_PINS];
+extern uint64_t hostNanos;
+
+void hostReset();
+
+inline void hostAdvanceNanos(uint64_t ns) { hostNanos += ns; }
+inline unsigned long millis() { return (unsigned long)(hostNanos / 1000000); }
+inline unsigned long micros() { return (unsigned long)(hostNanos / 1000); }
+inline void delay(unsigned long ms) { hostAdvanceNanos((uint64_t)ms * 1000000); }
+inline void delayMicroseconds(unsigned int us) { hostAdvanceNanos((uint64_t)us * 1000); }
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t pin, uint8_t level) { hostPinLevels[pin % HOST_PINS] = level; }
+inline int digitalRead(uint8_t pin) { return hostPinLevels[pin % HOST_PINS]; }
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+class String {
+    public:
+        String(const char *text = "") : text(text) {}
+
+        unsigned int length() const { return text.size(); }
+        const char *c_str() const { return text.c_str(); }
+        char operator[](unsigned int index) const { return text[index]; }
+
+    private:
+        std::string text;
+};
+
+class Print {
+    public:
+        virtual ~Print() {}
+
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t *buffer, size_t size) {
+            size_t n = 0;
+            while (size--) {
+                n += write(*buffer++);
+            }
+            return n;
+        }
+        size_t write(const char *text) { return text ? write((const uint8_t *)text, strlen(text)) : 0; }
+
+        size_t print(const char *text) { return write(text); }
+        size_t print(const String &text) { return write(text.c_str()); }
+        size_t print(const __FlashStringHelper *text) { return write((const char *)text); }
+        size_t print(char c) { return write((uint8_t)c); }
+        size_t print(long value, int base = DEC) {
+            char digits[24];
+            snprintf(digits, sizeof(digits), base == HEX ? "%lX" : "%ld", value);
+            return write(digits);
+        }
+        size_t print(int value, int base = DEC) { return print((long)value, base); }
+        size_t print(unsigned int value, int base = DEC) { return print((long)value, base); }
+        size_t println() { return write('\n'); }
+        template <typename T> size_t println(T value) { return print(value) + println(); }
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef SPI_h
+#define SPI_h
+
+// Host stand-in for the Arduino SPI library. Bytes clocked out while the attached chip select pin is low are logged
+// together with the level of the data/command pin, which is how SH1106_Model tells commands from display data.
+
+#include <Arduino.h>
+#include <vector>
+
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+struct SPIByte {
+    bool data;
+    uint8_t value;
+};
+
+class SPISettings {
+    public:
+        SPISettings(uint32_t clock = 4000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0) : clock(clock) {
+            (void)bitOrder;
+            (void)dataMode;
+        }
+
+        uint32_t clock;
+};
+
+class SPIClass {
+    public:
+        SPIClass();
+
+        void begin();
+        void beginTransaction(SPISettings settings);
+        void endTransaction();
+        uint8_t transfer(uint8_t value);
+
+        void attach(uint8_t dcPin, uint8_t csPin);
+        const std::vector<SPIByte> &getLog() const;
+        void clearLog();
+
+    private:
+        uint8_t dcPin;
+        uint8_t csPin;
+        uint32_t clock;
+        std::vector<SPIByte> log;
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef TwoWire_h
+#define TwoWire_h
+
+// Host stand-in for the Arduino Wire library. Each completed transmission is appended to a log for SH1106_Model and the
+// tests to inspect, and advances the virtual clock by the time the bytes would take on the bus at the configured clock.
+
+#include <Arduino.h>
+#include <vector>
+
+#define BUFFER_LENGTH 32
+
+struct WireTransaction {
+    uint8_t address;
+    std::vector<uint8_t> bytes;
+};
+
+class TwoWire {
+    public:
+        TwoWire();
+
+        void begin();
+        void setClock(uint32_t frequency);
+        void beginTransmission(uint8_t address);
+        size_t write(uint8_t value);
+        size_t write(const uint8_t *values, size_t count);
+        uint8_t endTransmission(bool sendStop = true);
+
+        uint32_t getClock() const;
+        uint64_t getBusMicros() const;
+        const std::vector<WireTransaction> &getLog() const;
+        void clearLog();
+
+    private:
+        uint32_t clock;
+        uint64_t busNanos;
+        bool transmitting;
+        WireTransaction current;
+        std::vector<WireTransaction> log;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef pgmspace_h
+#define pgmspace_h
+
+// On the host PROGMEM data is ordinary memory, so flash reads are plain loads
+
+#include <stdint.h>
+#include <string.h>
+
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#define pgm_read_dword(address) (*(const uint32_t *)(address))
+#define pgm_read_ptr(address) (*(void *const *)(address))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#endif
@@ -0,0 +1,58 @@
+// Counting replacements for the global allocators, shared by the tests that check code allocates nothing on the heap.
+// They define the allocator functions, so include this from a test's single source file only.
+
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Heap allocations are counted while counting is switched on. operator new covers the C++ side, and on glibc the
+// C allocator is wrapped too.
+static bool countAllocations = false;
+static uint32_t allocations = 0;
+
+void *operator new(size_t size) {
+    allocations += countAllocations;
+    void *memory = malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    free(memory);
+}
+
+#ifdef __GLIBC__
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *memory, size_t size);
+
+extern "C" void *malloc(size_t size) {
+    allocations += countAllocations;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) {
+    allocations += countAllocations;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *memory, size_t size) {
+    allocations += countAllocations;
+    return __libc_realloc(memory, size);
+}
+#endif
+
+#endif
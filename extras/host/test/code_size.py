@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""Reports the code size of the pixel, line and outline routines of SH1106_OLED and of SH1106_OLED_Fixed<128, 64>.
+
+Sizes are summed from the symbol table of the host build, so they show the relative cost of the two classes rather
+than AVR flash use. The runtime routines also call the span fill and dirty tracking helpers, which the fills and text
+share and which are not counted.
+
+    code_size.py NM RUNTIME_ARCHIVE FIXED_ARCHIVE
+"""
+
+import re
+import subprocess
+import sys
+
+ROUTINES = {
+    "getPixel", "setPixel", "clearPixel", "invertPixel", "drawHLine", "drawVLine", "drawCircle", "drawRect",
+    "drawRoundedRect", "drawArc", "drawArcRaw", "drawTriangleFill", "plotClipped", "markColumn", "markSpan",
+}
+TEMPLATES = {"outlineRect", "outlineRoundedRect", "outlineCircle", "outlineCorner", "outlineArc", "fillTriangle"}
+FIXED = "SH1106_OLED_Fixed<"
+
+
+def symbols(nm, path):
+    """Yields the size and demangled name of each defined function."""
+    output = subprocess.run([nm, "-S", "-C", "--defined-only", path], check=True, stdout=subprocess.PIPE,
+                            universal_newlines=True).stdout
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) == 4 and fields[2] in "TtWw":
+            yield int(fields[1], 16), fields[3]
+
+
+def measure(nm, path, fixed):
+    """Sums the sizes of the routines of one class, including the shape templates instantiated for it."""
+    total = 0
+    seen = set()
+    for size, name in symbols(nm, path):
+        match = re.match(r"(?:\S+ )?(SH1106_OLED(?:_Fixed<[^>]*>)?)::(\w+)(<.*>)?\(", name)
+        if not match or name in seen:
+            continue
+
+        owner, routine, arguments = match.groups()
+        if routine in TEMPLATES:
+            if arguments and (FIXED in arguments) == fixed:
+                total += size
+                seen.add(name)
+        elif routine in ROUTINES and owner.startswith(FIXED) == fixed:
+            total += size
+            seen.add(name)
+
+    return total
+
+
+def main():
+    nm, runtime, fixed = sys.argv[1:4]
+    runtime_bytes = measure(nm, runtime, False)
+    fixed_bytes = measure(nm, fixed, True)
+    print("METRIC runtime_drawing_code_bytes %d bytes" % runtime_bytes)
+    print("METRIC fixed_drawing_code_bytes %d bytes" % fixed_bytes)
+    if runtime_bytes == 0 or fixed_bytes == 0:
+        print("FAILED: no drawing routines found")
+        return 1
+
+    print("OK")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
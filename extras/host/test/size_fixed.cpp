@@ -0,0 +1,5 @@
+// Instantiates every member of a fixed size display, so code_size.py can measure the code it generates
+
+#include "SH1106_OLED_Fixed.h"
+
+template class SH1106_OLED_Fixed<128, 64>;
@@ -0,0 +1,99 @@
+#ifndef SH1106_test_h
+#define SH1106_test_h
+
+// Minimal assertion helpers for the host tests. Each test is its own executable, returning non-zero if any check failed.
+// Measurements are printed as "METRIC <name> <value> <unit>" lines so they can be collected from the ctest output.
+
+#include <Arduino.h>
+#include "SH1106_OLED.h"
+#include "SH1106_Model.h"
+
+static int testFailures = 0;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+        testFailures++; \
+    } \
+} while (0)
+
+#define CHECK_EQUAL(expected, actual) do { \
+    long long expectedValue = (long long)(expected); \
+    long long actualValue = (long long)(actual); \
+    if (expectedValue != actualValue) { \
+        printf("%s:%d: CHECK_EQUAL(%s, %s) failed: expected %lld, got %lld\n", __FILE__, __LINE__, #expected, #actual, expectedValue, actualValue); \
+        testFailures++; \
+    } \
+} while (0)
+
+static void metric(const char *name, double value, const char *unit) {
+    printf("METRIC %s %g %s\n", name, value, unit);
+}
+
+static int testResult() {
+    printf("%s\n", testFailures ? "FAILED" : "OK");
+    return testFailures ? 1 : 0;
+}
+
+
+// Returns the buffer pixel a panel pixel should show, given the display's orientation and start line
+static bool expectedPanelPixel(SH1106_OLED &oled, uint8_t x, uint8_t y) {
+    uint8_t width = oled.getWidth();
+    uint8_t height = oled.getHeight();
+    if (oled.getOrientation() == ORIENTATION_FLIPPED) {
+        x = width - 1 - x;
+        y = height - 1 - y;
+    }
+
+    return oled.getPixel(x, (y + oled.getStartLine()) % height) != oled.isInverse();
+}
+
+
+// Counts panel pixels of the model that differ from what the display's buffer says should be shown
+static uint32_t countPanelErrors(const SH1106_Model &model, SH1106_OLED &oled) {
+    uint32_t errors = 0;
+    for (uint8_t y = 0; y < oled.getHeight(); y++) {
+        for (uint8_t x = 0; x < oled.getWidth(); x++) {
+            errors += model.getPanelPixel(x, y) != expectedPanelPixel(oled, x, y);
+        }
+    }
+
+    return errors;
+}
+
+
+// Deterministic pseudo-random numbers, so every run draws the same shapes
+static uint32_t nextRandom(uint32_t &seed) {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) & 0x7FFF;
+}
+
+
+// Draws one pseudo-random shape, text or bitmap, with coordinates that sometimes run off the screen
+static void drawRandomShape(SH1106_OLED &oled, uint32_t &seed) {
+    static const uint8_t pattern[] = { 0x3C, 0x42, 0x81, 0xA5, 0x81, 0x99, 0x42, 0x3C, 0x0F, 0xF0, 0x0F, 0xF0 };
+    uint8_t x1 = nextRandom(seed) % (oled.getWidth() + 8);
+    uint8_t y1 = nextRandom(seed) % (oled.getHeight() + 8);
+    uint8_t x2 = nextRandom(seed) % (oled.getWidth() + 8);
+    uint8_t y2 = nextRandom(seed) % (oled.getHeight() + 8);
+    uint8_t size = nextRandom(seed) % 24;
+
+    switch (nextRandom(seed) % 14) {
+        case 0: oled.setPixel(x1, y1); break;
+        case 1: oled.clearPixel(x1, y1); break;
+        case 2: oled.invertPixel(x1, y1); break;
+        case 3: oled.drawHLine(x1, x2, y1); break;
+        case 4: oled.drawVLine(y1, y2, x1); break;
+        case 5: oled.drawLine(x1, y1, x2, y2); break;
+        case 6: oled.drawRect(x1, y1, size + 1, size / 2 + 1); break;
+        case 7: oled.drawRectFill(x1, y1, size + 1, size / 2 + 1); break;
+        case 8: oled.drawCircle(x1, y1, size); break;
+        case 9: oled.drawCircleFill(x1, y1, size / 2); break;
+        case 10: oled.print("AB12:", x1, y1); break;
+        case 11: oled.drawBitmap(pattern, (int16_t)x1 - 4, (int16_t)y1 - 4, 6, 16, (BitmapMode)(size % 4), false); break;
+        case 12: oled.displayBattery(size * 4); break;
+        case 13: oled.drawTriangleFill(x1, y1, x2, y2, x1 / 2 + 3, y2 / 2 + 1); break;
+    }
+}
+
+#endif
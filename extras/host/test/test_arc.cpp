@@ -0,0 +1,232 @@
+// Arcs, thick arcs and pies follow the circle rasteriser and the requested angles, and the midpoint arc walk is
+// compared with the original float angle stepping
+
+#include "test.h"
+#include <math.h>
+
+// Angles are in degrees, clockwise from +x with y pointing down. Direction vectors are quantised to 1/256,
+// which moves an arc edge by under a quarter of a degree.
+static const double ANGLE_TOLERANCE = 1.0;
+
+
+static double getPixelAngle(int dx, int dy) {
+    double angle = atan2((double)dy, (double)dx) * 180.0 / M_PI;
+    return angle < 0 ? angle + 360.0 : angle;
+}
+
+
+// Returns 1 if the angle is inside the range by more than the tolerance, -1 if outside by more, and 0 on an edge.
+// Equal angles draw nothing, while other ranges that are a whole number of turns draw the full circle.
+static int8_t classifyAngle(double angle, uint16_t startAngle, uint16_t endAngle) {
+    if (startAngle == endAngle) {
+        return -1;
+    }
+
+    double sweep = fmod(endAngle % 360 + 360.0 - startAngle % 360, 360.0);
+    if (sweep == 0) {
+        return 1;
+    }
+
+    double offset = fmod(angle - startAngle % 360 + 360.0, 360.0);
+    if (offset > ANGLE_TOLERANCE && offset < sweep - ANGLE_TOLERANCE) {
+        return 1;
+    }
+
+    if (offset > sweep + ANGLE_TOLERANCE && offset < 360.0 - ANGLE_TOLERANCE) {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+// The original drawArcRaw, stepping a float angle by about one pixel of arc length and reading a 91 entry float
+// sine table. Returns the number of steps, each costing two table lookups and two float multiplies.
+struct FloatArc {
+    float sineTable[91];
+
+    FloatArc() {
+        for (uint8_t i = 0; i <= 90; i++) {
+            sineTable[i] = sin(i * M_PI / 180.0);
+        }
+    }
+
+    float getSine(int angle) {
+        if (angle <= 90) return sineTable[angle];
+        if (angle < 180) return sineTable[180 - angle];
+        if (angle <= 270) return -sineTable[angle - 180];
+        return -sineTable[360 - angle];
+    }
+
+    float getCosine(int angle) {
+        if (angle <= 90) return sineTable[90 - angle];
+        if (angle < 180) return -sineTable[angle - 90];
+        if (angle <= 270) return -sineTable[270 - angle];
+        return sineTable[angle - 270];
+    }
+
+    uint32_t draw(bool *lit, int xCentre, int yCentre, uint8_t radius, uint16_t startAngle, uint16_t endAngle) {
+        uint32_t steps = 0;
+        float angleIncrement = 180 / (radius * PI);
+        float angle = startAngle + angleIncrement;
+        while (angle < endAngle) {
+            int x = (int)(radius * getCosine((int)angle));
+            int y = (int)(radius * getSine((int)angle));
+            int px = xCentre + x;
+            int py = yCentre + y;
+            if (px >= 0 && px < 128 && py >= 0 && py < 64) {
+                lit[px + py * 128] = true;
+            }
+            angle += angleIncrement;
+            steps++;
+        }
+
+        return steps;
+    }
+};
+
+
+static bool circlePixels[128 * 64];
+
+static void drawCircleReference(SH1106_OLED &oled, uint8_t x, uint8_t y, uint8_t radius) {
+    oled.clear();
+    oled.drawCircle(x, y, radius);
+    for (uint8_t py = 0; py < 64; py++) {
+        for (uint8_t px = 0; px < 128; px++) {
+            circlePixels[px + py * 128] = oled.getPixel(px, py);
+        }
+    }
+}
+
+
+// Checks an arc drawn with drawArcRaw against the circle: only circle pixels, none outside the range, all inside it
+static uint32_t checkArc(SH1106_OLED &oled, uint8_t xCentre, uint8_t yCentre, uint8_t radius, uint16_t startAngle, uint16_t endAngle) {
+    drawCircleReference(oled, xCentre, yCentre, radius);
+    oled.clear();
+    oled.drawArcRaw(xCentre, yCentre, radius, startAngle, endAngle);
+
+    uint32_t errors = 0;
+    for (uint8_t y = 0; y < 64; y++) {
+        for (uint8_t x = 0; x < 128; x++) {
+            bool lit = oled.getPixel(x, y);
+            bool onCircle = circlePixels[x + y * 128];
+            int8_t inside = classifyAngle(getPixelAngle(x - xCentre, y - yCentre), startAngle, endAngle);
+            if ((lit && !onCircle) || (lit && inside < 0) || (!lit && onCircle && inside > 0)) {
+                errors++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+
+// Checks a filled ring against the radius band of the circle rasteriser and the angular range. An inner radius of
+// zero is a pie.
+static uint32_t checkRing(SH1106_OLED &oled, uint8_t xCentre, uint8_t yCentre, uint8_t radius, uint8_t thickness, uint16_t startAngle, uint16_t endAngle) {
+    oled.clear();
+    uint8_t innerRadius = 0;
+    if (thickness) {
+        oled.drawArcThick(xCentre, yCentre, radius, thickness, startAngle, endAngle);
+        innerRadius = thickness > radius ? 0 : radius - thickness + 1;
+    } else {
+        oled.drawPie(xCentre, yCentre, radius, startAngle, endAngle);
+    }
+
+    int32_t outerLimit = (int32_t)radius * radius + radius;
+    int32_t innerLimit = innerRadius ? (int32_t)innerRadius * innerRadius - innerRadius + 1 : 0;
+    uint32_t errors = 0;
+    for (uint8_t y = 0; y < 64; y++) {
+        for (uint8_t x = 0; x < 128; x++) {
+            int dx = x - xCentre;
+            int dy = y - yCentre;
+            int32_t distance = (int32_t)dx * dx + (int32_t)dy * dy;
+            bool inBand = distance <= outerLimit && distance >= innerLimit;
+            int8_t inside = (dx == 0 && dy == 0) ? 0 : classifyAngle(getPixelAngle(dx, dy), startAngle, endAngle);
+            bool lit = oled.getPixel(x, y);
+            if ((lit && !inBand) || (lit && inside < 0) || (!lit && inBand && inside > 0)) {
+                errors++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+
+int main() {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    oled.init();
+
+    // A full range is exactly the circle
+    static const uint8_t radii[] = { 1, 2, 5, 8, 13, 20, 31 };
+    for (uint8_t i = 0; i < sizeof(radii); i++) {
+        drawCircleReference(oled, 64, 32, radii[i]);
+        oled.clear();
+        oled.drawArcRaw(64, 32, radii[i], 0, 360);
+        bool same = true;
+        for (uint8_t y = 0; y < 64; y++) {
+            for (uint8_t x = 0; x < 128; x++) {
+                same &= oled.getPixel(x, y) == circlePixels[x + y * 128];
+            }
+        }
+        CHECK(same);
+    }
+
+    // Partial and wrapping ranges, including ranges across 0 degrees and centres near the edges
+    uint32_t seed = 7;
+    uint32_t arcErrors = 0;
+    uint32_t ringErrors = 0;
+    for (uint16_t i = 0; i < 600; i++) {
+        uint8_t x = nextRandom(seed) % 128;
+        uint8_t y = nextRandom(seed) % 64;
+        uint8_t radius = 1 + nextRandom(seed) % 40;
+        uint16_t startAngle = nextRandom(seed) % 360;
+        uint16_t endAngle = nextRandom(seed) % 720;
+        uint8_t thickness = nextRandom(seed) % 12;
+        arcErrors += checkArc(oled, x, y, radius, startAngle, endAngle);
+        ringErrors += checkRing(oled, x, y, radius, thickness, startAngle, endAngle);
+    }
+    CHECK_EQUAL(0, arcErrors);
+    CHECK_EQUAL(0, ringErrors);
+    CHECK_EQUAL(0, checkArc(oled, 64, 32, 20, 300, 60));
+    CHECK_EQUAL(0, checkRing(oled, 64, 32, 20, 4, 350, 10));
+    CHECK_EQUAL(0, checkRing(oled, 64, 32, 20, 0, 90, 359));
+
+    // Work per quarter arc and circle pixels the original float stepping missed. The midpoint walk visits one
+    // position per pixel of a circle octant and tests eight integer cross products there.
+    FloatArc floatArc;
+    static bool floatPixels[128 * 64];
+    static const uint8_t benchRadii[] = { 8, 16, 31 };
+    for (uint8_t i = 0; i < sizeof(benchRadii); i++) {
+        uint8_t radius = benchRadii[i];
+        memset(floatPixels, 0, sizeof(floatPixels));
+        uint32_t floatSteps = floatArc.draw(floatPixels, 64, 32, radius, 0, 90);
+
+        drawCircleReference(oled, 64, 32, radius);
+        uint32_t walkPositions = 0;
+        uint32_t missed = 0;
+        uint32_t offCircle = 0;
+        for (uint8_t y = 32; y < 64; y++) {
+            for (uint8_t x = 64; x < 128; x++) {
+                bool onCircle = circlePixels[x + y * 128];
+                walkPositions += onCircle && (x - 64) <= (y - 32);
+                missed += onCircle && !floatPixels[x + y * 128];
+                offCircle += floatPixels[x + y * 128] && !onCircle;
+            }
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "arc90_r%d_float_steps", radius);
+        metric(name, floatSteps, "steps");
+        snprintf(name, sizeof(name), "arc90_r%d_walk_positions", radius);
+        metric(name, walkPositions, "positions");
+        snprintf(name, sizeof(name), "arc90_r%d_float_missed_pixels", radius);
+        metric(name, missed, "pixels");
+        snprintf(name, sizeof(name), "arc90_r%d_float_off_circle_pixels", radius);
+        metric(name, offCircle, "pixels");
+    }
+
+    return testResult();
+}
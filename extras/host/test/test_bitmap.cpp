@@ -0,0 +1,141 @@
+// Every bitmap mode and masked bitmaps match a per-pixel reference blit at any position, including off the left, top,
+// right and bottom edges and at every row offset within a page, under any clip rectangle, from RAM and from PROGMEM,
+// and leave the pixels outside the clip rectangle unchanged
+
+#include "test.h"
+
+#define MAX_SIZE 40
+#define DRAW_MASKED 4
+
+// pgm_read_byte() is a plain read on the host, so the same arrays serve as RAM and PROGMEM sources
+static uint8_t bitmap[MAX_SIZE * ((MAX_SIZE + 7) / 8)];
+static uint8_t mask[MAX_SIZE * ((MAX_SIZE + 7) / 8)];
+
+
+static bool getBit(const uint8_t *data, uint8_t width, uint8_t i, uint8_t j) {
+    return (data[i + (j / 8) * width] >> (j & 0x07)) & 0x01;
+}
+
+
+// Combines the bitmap with a copy of the buffer one pixel at a time, inside the screen and clip rectangle
+static void referenceBlit(uint8_t *buffer, int16_t x, int16_t y, uint8_t w, uint8_t h, uint8_t mode, int16_t clipX1, int16_t clipY1, int16_t clipX2, int16_t clipY2) {
+    for (uint8_t j = 0; j < h; j++) {
+        for (uint8_t i = 0; i < w; i++) {
+            int16_t px = x + i;
+            int16_t py = y + j;
+            if (px < 0 || px > 127 || py < 0 || py > 63 || px < clipX1 || px > clipX2 || py < clipY1 || py > clipY2) {
+                continue;
+            }
+
+            uint8_t &byte = buffer[px + (py / 8) * 128];
+            uint8_t bit = 0x01 << (py & 0x07);
+            bool source = getBit(bitmap, w, i, j);
+            bool pixel = byte & bit;
+            switch (mode) {
+                case BITMAP_OR: pixel = pixel || source; break;
+                case BITMAP_AND: pixel = pixel && source; break;
+                case BITMAP_XOR: pixel = pixel != source; break;
+                case BITMAP_COPY: pixel = source; break;
+                case DRAW_MASKED: pixel = getBit(mask, w, i, j) ? source : pixel; break;
+            }
+            byte = pixel ? byte | bit : byte & ~bit;
+        }
+    }
+}
+
+
+// Picks a position that is often at or across an edge of the screen
+static int16_t randomPosition(uint8_t size, uint8_t screenSize, uint32_t &seed) {
+    switch (nextRandom(seed) % 4) {
+        case 0: return -(int16_t)(nextRandom(seed) % (size + 1));
+        case 1: return screenSize - size + (int16_t)(nextRandom(seed) % (size + 1));
+        default: return (int16_t)(nextRandom(seed) % (screenSize + 8)) - 4;
+    }
+}
+
+
+int main() {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    SH1106_Model model;
+    oled.init();
+
+    uint32_t seed = 21;
+    for (uint8_t i = 0; i < 30; i++) {
+        drawRandomShape(oled, seed);
+    }
+
+    uint32_t wrongPixels = 0;
+    uint32_t outsideChanges = 0;
+    uint32_t panelErrors = 0;
+    uint32_t blits[DRAW_MASKED + 1][2] = {};
+    for (uint16_t step = 0; step < 20000; step++) {
+        for (size_t i = 0; i < sizeof(bitmap); i++) {
+            bitmap[i] = nextRandom(seed);
+            mask[i] = nextRandom(seed);
+        }
+
+        uint8_t w = 1 + nextRandom(seed) % MAX_SIZE;
+        uint8_t h = 1 + nextRandom(seed) % MAX_SIZE;
+        int16_t x = randomPosition(w, 128, seed);
+        int16_t y = randomPosition(h, 64, seed);
+        uint8_t mode = nextRandom(seed) % (DRAW_MASKED + 1);
+        bool inProgmem = nextRandom(seed) % 2;
+
+        if (nextRandom(seed) % 4 == 0) {
+            oled.resetClipRect();
+        } else {
+            int16_t x1 = (int16_t)(nextRandom(seed) % 140) - 4;
+            int16_t y1 = (int16_t)(nextRandom(seed) % 72) - 4;
+            oled.setClipRect(x1, y1, x1 + nextRandom(seed) % 80, y1 + nextRandom(seed) % 48);
+        }
+        int16_t clipX1, clipY1, clipX2, clipY2;
+        oled.getClipRect(clipX1, clipY1, clipX2, clipY2);
+
+        uint8_t before[1024];
+        uint8_t expected[1024];
+        memcpy(before, oled.getBuffer(), sizeof(before));
+        memcpy(expected, before, sizeof(expected));
+        referenceBlit(expected, x, y, w, h, mode, clipX1, clipY1, clipX2, clipY2);
+
+        if (mode == DRAW_MASKED) {
+            oled.drawBitmapMasked(bitmap, mask, x, y, w, h, inProgmem);
+        } else {
+            oled.drawBitmap(bitmap, x, y, w, h, (BitmapMode)mode, inProgmem);
+        }
+        blits[mode][inProgmem]++;
+
+        const uint8_t *buffer = oled.getBuffer();
+        for (uint8_t py = 0; py < 64; py++) {
+            for (uint8_t px = 0; px < 128; px++) {
+                uint16_t index = px + (py / 8) * 128;
+                uint8_t bit = 0x01 << (py & 0x07);
+                if (px < clipX1 || px > clipX2 || py < clipY1 || py > clipY2) {
+                    outsideChanges += (buffer[index] & bit) != (before[index] & bit);
+                } else {
+                    wrongPixels += (buffer[index] & bit) != (expected[index] & bit);
+                }
+            }
+        }
+
+        // Everything that changed was marked, so the panel matches the buffer after each display()
+        if (step % 100 == 99) {
+            oled.display();
+            model.receive(Wire);
+            panelErrors += countPanelErrors(model, oled);
+        }
+    }
+
+    CHECK_EQUAL(0, wrongPixels);
+    CHECK_EQUAL(0, outsideChanges);
+    CHECK_EQUAL(0, panelErrors);
+    for (uint8_t mode = 0; mode <= DRAW_MASKED; mode++) {
+        CHECK(blits[mode][false] > 0 && blits[mode][true] > 0);
+    }
+
+    metric("wrong_pixels", wrongPixels, "pixels");
+    metric("pixels_changed_outside_clip", outsideChanges, "pixels");
+    metric("panel_errors", panelErrors, "pixels");
+
+    return testResult();
+}
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Checks that bitmap2rle.py reads every input format with the same polarity and that --invert means the same for all."""
+
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SCRIPT = os.path.join(HERE, "..", "..", "bitmap2rle.py")
+sys.path.insert(0, os.path.dirname(SCRIPT))
+
+import bitmap2rle  # noqa: E402
+
+# Light pixels, which are lit on the display
+PATTERN = [
+    [1, 1, 0, 0, 1, 0, 1, 0, 0, 1],
+    [0, 1, 1, 0, 0, 0, 0, 1, 1, 1],
+    [1, 0, 0, 0, 1, 1, 0, 0, 1, 0],
+]
+
+
+def write_pbm(path, rows, binary):
+    """Writes a PBM, where 1 is black, so lit pixels are written as 0."""
+    height, width = len(rows), len(rows[0])
+    with open(path, "wb") as f:
+        if binary:
+            f.write(b"P4\n%d %d\n" % (width, height))
+            for row in rows:
+                bits = [1 - p for p in row] + [0] * (-width % 8)
+                f.write(bytes(sum(bit << (7 - i) for i, bit in enumerate(bits[j:j + 8])) for j in range(0, len(bits), 8)))
+        else:
+            f.write(b"P1\n# comment\n%d %d\n" % (width, height))
+            for row in rows:
+                f.write((" ".join(str(1 - p) for p in row) + "\n").encode())
+
+
+def convert(path, invert):
+    """Runs the script and returns the decompressed page bytes of the generated array."""
+    command = [sys.executable, SCRIPT, path, "image"] + (["--invert"] if invert else [])
+    header = subprocess.run(command, check=True, capture_output=True, text=True).stdout
+    body = header[header.index("{") + 1:header.index("}")]
+    encoded = [int(value, 16) for value in body.replace(",", " ").split()]
+    width, height = encoded[0], encoded[1]
+    return bitmap2rle.decompress(encoded[2:], width * ((height + 7) // 8))
+
+
+class PolarityTest(unittest.TestCase):
+    def setUp(self):
+        self.directory = tempfile.TemporaryDirectory()
+
+    def tearDown(self):
+        self.directory.cleanup()
+
+    def path(self, name):
+        return os.path.join(self.directory.name, name)
+
+    def test_pbm_formats_light_white_pixels(self):
+        for binary, name in ((False, "p1.pbm"), (True, "p4.pbm")):
+            write_pbm(self.path(name), PATTERN, binary)
+            width, height, rows = bitmap2rle.load_image(self.path(name))
+            self.assertEqual((width, height), (10, 3))
+            self.assertEqual(rows, PATTERN)
+
+    def test_invert_lights_dark_pixels(self):
+        write_pbm(self.path("p4.pbm"), PATTERN, True)
+        expected = bitmap2rle.pack_pages(10, 3, PATTERN)
+        self.assertEqual(convert(self.path("p4.pbm"), False), expected)
+        self.assertEqual(convert(self.path("p4.pbm"), True), [byte ^ 0x07 for byte in expected])
+
+    def test_pillow_matches_pbm(self):
+        try:
+            from PIL import Image
+        except ImportError:
+            self.skipTest("Pillow is not installed")
+
+        image = Image.new("L", (10, 3))
+        for y, row in enumerate(PATTERN):
+            for x, lit in enumerate(row):
+                image.putpixel((x, y), 255 if lit else 0)
+        image.save(self.path("image.png"))
+        write_pbm(self.path("image.pbm"), PATTERN, True)
+
+        for invert in (False, True):
+            self.assertEqual(convert(self.path("image.png"), invert), convert(self.path("image.pbm"), invert))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,104 @@
+// The scrolling console shows the last lines written, on short panels and with double buffering
+
+#include "test.h"
+#include "SH1106_Console.h"
+
+// Counts panel pixels that differ from the expected lines drawn top to bottom on an unscrolled display
+static uint32_t countTextErrors(const SH1106_Model &model, SH1106_OLED &reference, const char lines[][16], uint16_t lineCount) {
+    uint8_t rows = reference.getHeight() / 8;
+    reference.clear();
+    uint16_t first = lineCount > rows ? lineCount - rows : 0;
+    for (uint16_t i = first; i < lineCount; i++) {
+        reference.print(lines[i % 64], 0, (i - first) * 8);
+    }
+
+    uint32_t errors = 0;
+    for (uint8_t y = 0; y < reference.getHeight(); y++) {
+        for (uint8_t x = 0; x < reference.getWidth(); x++) {
+            errors += model.getPanelPixel(x, y) != reference.getPixel(x, y);
+        }
+    }
+
+    return errors;
+}
+
+
+static uint32_t runConsole(uint8_t height, int8_t doubleBuffer, uint32_t &bytesPerLine) {
+    hostReset();
+    SH1106_OLED oled(128, height, 0x3C);
+    SH1106_OLED reference(128, height, 0x3D);
+    SH1106_Model model(128, height, 2);
+    oled.init();
+    reference.init();
+    if (doubleBuffer >= 0) {
+        CHECK(oled.enableDoubleBuffer(doubleBuffer));
+    }
+
+    SH1106_Console console(oled);
+    console.clear();
+
+    static char lines[64][16];
+    uint32_t seed = 5 + height;
+    uint32_t errors = 0;
+    uint32_t sentBefore = oled.getBytesSent();
+    const uint16_t lineCount = 200;
+    for (uint16_t i = 0; i < lineCount; i++) {
+        // Each line is written a few characters at a time, with a display() after each part
+        snprintf(lines[i % 64], sizeof(lines[0]), "LINE %u %u", i, (unsigned)(nextRandom(seed) % 1000));
+        const char *p = lines[i % 64];
+        while (*p) {
+            uint8_t part = 1 + nextRandom(seed) % 4;
+            for (uint8_t j = 0; j < part && *p; j++) {
+                console.write(*p++);
+            }
+
+            oled.display();
+            model.receive(Wire, 0x3C);
+            errors += countPanelErrors(model, oled);
+        }
+
+        console.write('\n');
+        errors += countTextErrors(model, reference, lines, i + 1);
+    }
+    bytesPerLine = (oled.getBytesSent() - sentBefore) / lineCount;
+
+    // Redrawing after other content was drawn over the console restores it
+    oled.drawRectFill(10, 0, 60, height - 1);
+    console.redraw();
+    oled.display();
+    model.receive(Wire, 0x3C);
+    errors += countPanelErrors(model, oled);
+    errors += countTextErrors(model, reference, lines, lineCount);
+
+    // Writing and redrawing keep the caller's clip rectangle
+    oled.setClipRect(20, 4, 90, height - 5);
+    console.write('X');
+    console.redraw();
+    int16_t x1, y1, x2, y2;
+    oled.getClipRect(x1, y1, x2, y2);
+    CHECK(x1 == 20 && y1 == 4 && x2 == 90 && y2 == height - 5);
+    oled.resetClipRect();
+
+    return errors;
+}
+
+
+int main() {
+    static const uint8_t heights[] = { 32, 64 };
+    for (uint8_t i = 0; i < sizeof(heights); i++) {
+        for (int8_t doubleBuffer = -1; doubleBuffer <= 1; doubleBuffer++) {
+            uint32_t bytesPerLine = 0;
+            uint32_t errors = runConsole(heights[i], doubleBuffer, bytesPerLine);
+            CHECK_EQUAL(0, errors);
+
+            static const char *modes[] = { "single", "swap", "diff" };
+            char name[64];
+            snprintf(name, sizeof(name), "height_%d_%s_wrong_pixels", heights[i], modes[doubleBuffer + 1]);
+            metric(name, errors, "pixels");
+            snprintf(name, sizeof(name), "height_%d_%s_bytes_per_line", heights[i], modes[doubleBuffer + 1]);
+            metric(name, bytesPerLine, "bytes");
+        }
+    }
+
+    return testResult();
+}
@@ -0,0 +1,87 @@
+// Dirty span tracking: partial updates leave the panel exactly as full refreshes do, while sending far fewer bytes
+
+#include "test.h"
+
+int main() {
+    hostReset();
+    // Each primitive marks just the bytes it touches
+    SH1106_OLED spans(128, 64, 0x3C);
+    spans.init();
+    spans.setPixel(5, 9);
+    CHECK_EQUAL(1, spans.getDirtyBytes());
+    spans.display();
+    spans.drawHLine(10, 49, 20);
+    CHECK_EQUAL(40, spans.getDirtyBytes());
+    spans.display();
+    spans.drawVLine(3, 60, 7);
+    CHECK_EQUAL(8, spans.getDirtyBytes());
+    spans.display();
+    spans.print("AB", 0, 0);
+    CHECK_EQUAL(9, spans.getDirtyBytes());
+    spans.display();
+    spans.print("AB", 0, 6);
+    CHECK_EQUAL(18, spans.getDirtyBytes());
+    spans.display();
+    spans.displayBattery(50);
+    CHECK_EQUAL(12, spans.getDirtyBytes());
+    spans.display();
+    spans.setPixel(130, 9);
+    CHECK_EQUAL(0, spans.getDirtyBytes());
+
+    // The same drawing sent with dirty spans and with a full refresh every frame
+    hostReset();
+    TwoWire partialBus;
+    TwoWire fullBus;
+    SH1106_I2C partialI2C(0x3C, partialBus);
+    SH1106_I2C fullI2C(0x3C, fullBus);
+    SH1106_OLED partial(128, 64, partialI2C);
+    SH1106_OLED full(128, 64, fullI2C);
+    SH1106_Model partialModel;
+    SH1106_Model fullModel;
+    partial.init();
+    full.init();
+
+    uint32_t seed = 1;
+    uint32_t frames = 200;
+    uint32_t errors = 0;
+    uint32_t ramDifferences = 0;
+    uint32_t partialStart = partial.getBytesSent();
+    uint32_t fullStart = full.getBytesSent();
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        uint32_t partialSeed = seed;
+        uint8_t shapes = 1 + nextRandom(seed) % 3;
+        for (uint8_t i = 0; i < shapes; i++) {
+            drawRandomShape(partial, partialSeed);
+        }
+        seed = partialSeed;
+
+        memcpy(full.getBuffer(), partial.getBuffer(), partial.getBufferSize());
+        full.invert();
+        full.invert();
+
+        partial.display();
+        full.display();
+        partialModel.receive(partialBus);
+        fullModel.receive(fullBus);
+
+        errors += countPanelErrors(partialModel, partial);
+        for (uint8_t page = 0; page < 8; page++) {
+            for (uint8_t column = 2; column < 130; column++) {
+                ramDifferences += partialModel.getRam(page, column) != fullModel.getRam(page, column);
+            }
+        }
+    }
+
+    CHECK_EQUAL(0, errors);
+    CHECK_EQUAL(0, ramDifferences);
+    CHECK_EQUAL(0, partialModel.overflowBytes);
+
+    uint32_t partialBytes = partial.getBytesSent() - partialStart;
+    uint32_t fullBytes = full.getBytesSent() - fullStart;
+    CHECK(partialBytes * 4 < fullBytes);
+    metric("partial_bytes_per_frame", (double)partialBytes / frames, "bytes");
+    metric("full_bytes_per_frame", (double)fullBytes / frames, "bytes");
+    metric("bytes_saved_per_frame", (double)partial.getBytesSaved() / frames, "bytes");
+
+    return testResult();
+}
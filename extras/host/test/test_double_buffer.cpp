@@ -0,0 +1,95 @@
+// Double buffering: frames drawn incrementally reach the panel intact in both modes, and drawing never tears the frame being sent
+
+#include "test.h"
+#include "SH1106_RecordingTransport.h"
+
+// Draws the same incremental sequence on a double-buffered display and a single-buffered reference, checking the panel each frame
+static uint32_t runIncremental(bool diff, uint32_t &bytesSent) {
+    hostReset();
+    SH1106_RecordingTransport transport;
+    SH1106_OLED oled(128, 64, transport);
+    SH1106_OLED reference(128, 64, 0x3D);
+    SH1106_Model model;
+    oled.init();
+    reference.init();
+    CHECK(oled.enableDoubleBuffer(diff));
+
+    uint32_t seed = 11;
+    uint32_t wrongBytes = 0;
+    uint32_t sentBefore = oled.getBytesSent();
+    for (uint16_t frame = 0; frame < 300; frame++) {
+        uint8_t shapes = 1 + nextRandom(seed) % 3;
+        for (uint8_t i = 0; i < shapes; i++) {
+            uint32_t shapeSeed = seed;
+            drawRandomShape(oled, seed);
+            drawRandomShape(reference, shapeSeed);
+        }
+
+        oled.display();
+        transport.replay(model);
+        for (uint8_t page = 0; page < 8; page++) {
+            for (uint8_t column = 0; column < 128; column++) {
+                wrongBytes += model.getRam(page, column + 2) != reference.getBuffer()[column + page * 128];
+            }
+        }
+        CHECK_EQUAL(0, memcmp(oled.getBuffer(), reference.getBuffer(), reference.getBufferSize()));
+    }
+
+    bytesSent = oled.getBytesSent() - sentBefore;
+    return wrongBytes;
+}
+
+
+int main() {
+    uint32_t swapBytes = 0;
+    uint32_t diffBytes = 0;
+    uint32_t swapWrong = runIncremental(false, swapBytes);
+    uint32_t diffWrong = runIncremental(true, diffBytes);
+    CHECK_EQUAL(0, swapWrong);
+    CHECK_EQUAL(0, diffWrong);
+    CHECK(diffBytes <= swapBytes);
+    metric("swap_mode_wrong_bytes", swapWrong, "bytes");
+    metric("diff_mode_wrong_bytes", diffWrong, "bytes");
+    metric("swap_mode_bytes_per_frame", swapBytes / 300.0, "bytes");
+    metric("diff_mode_bytes_per_frame", diffBytes / 300.0, "bytes");
+
+    // Drawing while a frame is streamed does not change what that frame sends
+    hostReset();
+    SH1106_RecordingTransport transport(16);
+    SH1106_OLED oled(128, 64, transport);
+    SH1106_Model model;
+    oled.init();
+    oled.enableDoubleBuffer();
+    uint32_t seed = 5;
+    uint32_t tornBytes = 0;
+    for (uint8_t frame = 0; frame < 50; frame++) {
+        for (uint8_t i = 0; i < 5; i++) {
+            drawRandomShape(oled, seed);
+        }
+
+        uint8_t snapshot[1024];
+        memcpy(snapshot, oled.getBuffer(), sizeof(snapshot));
+        oled.beginDisplay();
+        while (oled.pollDisplay()) {
+            drawRandomShape(oled, seed);
+        }
+        transport.replay(model);
+        for (uint16_t i = 0; i < sizeof(snapshot); i++) {
+            tornBytes += model.getRam(i / 128, (i % 128) + 2) != snapshot[i];
+        }
+    }
+    CHECK_EQUAL(0, tornBytes);
+
+    // Redrawing identical content sends nothing in diff mode
+    oled.enableDoubleBuffer(true);
+    oled.display();
+    uint8_t frameCopy[1024];
+    memcpy(frameCopy, oled.getBuffer(), sizeof(frameCopy));
+    oled.clear();
+    oled.drawBitmap(frameCopy, 0, 0, 128, 64, BITMAP_COPY, false);
+    size_t records = transport.records.size();
+    oled.display();
+    CHECK_EQUAL(records, transport.records.size());
+
+    return testResult();
+}
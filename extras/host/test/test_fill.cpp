@@ -0,0 +1,194 @@
+// Filled shapes match the original row-by-row fills pixel for pixel, and the column-span fill writes far fewer bytes
+
+#include "test.h"
+
+// The original fills, drawing one horizontal line per row with one read-modify-write per pixel, clipped to the screen
+struct ReferenceCanvas {
+    uint8_t buffer[1024];
+    uint32_t writes;
+
+    void clear() {
+        memset(buffer, 0, sizeof(buffer));
+        writes = 0;
+    }
+
+    void hLine(int x1, int x2, int y) {
+        if (x2 < x1) {
+            std::swap(x1, x2);
+        }
+        if (y < 0 || y >= 64) {
+            return;
+        }
+        for (int x = max(x1, 0); x <= min(x2, 127); x++) {
+            buffer[x + (y / 8) * 128] |= 1 << (y & 7);
+            writes++;
+        }
+    }
+
+    void vLine(int y1, int y2, int x) {
+        if (y2 < y1) {
+            std::swap(y1, y2);
+        }
+        for (int y = y1; y <= y2; y++) {
+            hLine(x, x, y);
+        }
+    }
+
+    void rectFill(int x, int y, int w, int h) {
+        for (int i = 0; i <= h; i++) {
+            hLine(x, x + w, y + i);
+        }
+    }
+
+    void circleFill(int xCentre, int yCentre, int radius) {
+        int f = 1 - radius, ddF_x = 1, ddF_y = -2 * radius, x = 0, y = radius;
+        hLine(xCentre - radius, xCentre + radius, yCentre);
+        while (x < y) {
+            if (f >= 0) {
+                y--;
+                ddF_y += 2;
+                f += ddF_y;
+            }
+            x++;
+            ddF_x += 2;
+            f += ddF_x;
+            hLine(xCentre - x, xCentre + x, yCentre + y);
+            hLine(xCentre - x, xCentre + x, yCentre - y);
+            hLine(xCentre - y, xCentre + y, yCentre + x);
+            hLine(xCentre - y, xCentre + y, yCentre - x);
+        }
+    }
+
+    void arcFill(int xCentre, int yCentre, int radius, Corner corner) {
+        int f = 1 - radius, ddF_x = 1, ddF_y = -2 * radius, x = 0, y = radius;
+        if (corner == BOTTOM_LEFT || corner == BOTTOM_RIGHT) vLine(yCentre, yCentre + radius, xCentre);
+        if (corner == TOP_LEFT || corner == TOP_RIGHT) vLine(yCentre - radius, yCentre, xCentre);
+        if (corner == TOP_RIGHT || corner == BOTTOM_RIGHT) hLine(xCentre, xCentre + radius, yCentre);
+        if (corner == TOP_LEFT || corner == BOTTOM_LEFT) hLine(xCentre, xCentre - radius, yCentre);
+        while (x < y) {
+            if (f >= 0) {
+                y--;
+                ddF_y += 2;
+                f += ddF_y;
+            }
+            x++;
+            ddF_x += 2;
+            f += ddF_x;
+            int sx = (corner == TOP_RIGHT || corner == BOTTOM_RIGHT) ? 1 : -1;
+            int sy = (corner == BOTTOM_LEFT || corner == BOTTOM_RIGHT) ? 1 : -1;
+            hLine(xCentre, xCentre + sx * x, yCentre + sy * y);
+            hLine(xCentre, xCentre + sx * y, yCentre + sy * x);
+        }
+    }
+
+    void roundedRectFill(int x, int y, int w, int h, int r) {
+        r = min(r, min(w, h) / 2);
+        for (int i = 0; i <= r; i++) {
+            hLine(x + r, x + w - r, y + i);
+            hLine(x + r, x + w - r, y + h - i);
+        }
+        for (int i = 0; i <= h - 2 * r; i++) {
+            hLine(x, x + w, y + r + i);
+        }
+        arcFill(x + r, y + r, r, TOP_LEFT);
+        arcFill(x + w - r, y + r, r, TOP_RIGHT);
+        arcFill(x + r, y + h - r, r, BOTTOM_LEFT);
+        arcFill(x + w - r, y + h - r, r, BOTTOM_RIGHT);
+    }
+};
+
+
+// Bytes a column-span fill writes for a shape: every page from the first to the last lit row of each column, once
+static uint32_t countSpanBytes(const uint8_t *buffer) {
+    uint32_t bytes = 0;
+    for (uint8_t x = 0; x < 128; x++) {
+        int first = -1;
+        int last = -1;
+        for (uint8_t page = 0; page < 8; page++) {
+            if (buffer[x + page * 128]) {
+                first = first < 0 ? page : first;
+                last = page;
+            }
+        }
+        bytes += first < 0 ? 0 : last - first + 1;
+    }
+
+    return bytes;
+}
+
+
+struct FillCase {
+    const char *name;
+    uint8_t shape;
+    uint8_t x, y, w, h, r;
+};
+
+
+static void drawLibrary(SH1106_OLED &oled, const FillCase &c) {
+    switch (c.shape) {
+        case 0: oled.drawRectFill(c.x, c.y, c.w, c.h); break;
+        case 1: oled.drawCircleFill(c.x, c.y, c.r); break;
+        case 2: oled.drawArcFill(c.x, c.y, c.r, (Corner)(c.w % 4)); break;
+        case 3: oled.drawRoundedRectFill(c.x, c.y, c.w, c.h, c.r); break;
+    }
+}
+
+
+static void drawReference(ReferenceCanvas &canvas, const FillCase &c) {
+    switch (c.shape) {
+        case 0: canvas.rectFill(c.x, c.y, c.w, c.h); break;
+        case 1: canvas.circleFill(c.x, c.y, c.r); break;
+        case 2: canvas.arcFill(c.x, c.y, c.r, (Corner)(c.w % 4)); break;
+        case 3: canvas.roundedRectFill(c.x, c.y, c.w, c.h, c.r); break;
+    }
+}
+
+
+int main() {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    oled.init();
+    ReferenceCanvas canvas;
+
+    // Random shapes, many running off the screen, match exactly
+    uint32_t seed = 17;
+    uint32_t mismatches = 0;
+    for (uint16_t i = 0; i < 4000; i++) {
+        FillCase c = { "random", (uint8_t)(i % 4), (uint8_t)(nextRandom(seed) % 140), (uint8_t)(nextRandom(seed) % 72),
+            (uint8_t)(nextRandom(seed) % 90), (uint8_t)(nextRandom(seed) % 60), (uint8_t)(nextRandom(seed) % 40) };
+        oled.clear();
+        canvas.clear();
+        drawLibrary(oled, c);
+        drawReference(canvas, c);
+        if (memcmp(oled.getBuffer(), canvas.buffer, sizeof(canvas.buffer))) {
+            mismatches++;
+        }
+    }
+    CHECK_EQUAL(0, mismatches);
+
+    // Byte writes per call, original row-by-row fill against the column-span fill
+    static const FillCase cases[] = {
+        { "rect_full_screen", 0, 0, 0, 127, 63, 0 },
+        { "rect_32x16", 0, 40, 20, 31, 15, 0 },
+        { "circle_r31", 1, 64, 32, 0, 0, 31 },
+        { "circle_r8", 1, 20, 20, 0, 0, 8 },
+        { "arc_r20", 2, 64, 40, 1, 0, 20 },
+        { "rounded_rect_120x56_r8", 3, 4, 4, 120, 56, 8 }
+    };
+    for (uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const FillCase &c = cases[i];
+        oled.clear();
+        canvas.clear();
+        drawLibrary(oled, c);
+        drawReference(canvas, c);
+        CHECK_EQUAL(0, memcmp(oled.getBuffer(), canvas.buffer, sizeof(canvas.buffer)));
+
+        char name[64];
+        snprintf(name, sizeof(name), "%s_original_writes", c.name);
+        metric(name, canvas.writes, "bytes");
+        snprintf(name, sizeof(name), "%s_span_writes", c.name);
+        metric(name, countSpanBytes(oled.getBuffer()), "bytes");
+    }
+
+    return testResult();
+}
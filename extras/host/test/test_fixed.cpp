@@ -0,0 +1,242 @@
+// SH1106_OLED_Fixed draws exactly like SH1106_OLED, whether called directly or through an SH1106_OLED reference, every
+// shape leaves the pixels outside the clip rectangle unchanged, and a fixed size display needs no heap
+
+#include "test.h"
+#include "allocations.h"
+#include "SH1106_OLED_Fixed.h"
+#include <chrono>
+
+// Discards everything, so the bus log of the Wire stand-in does not count as allocations by the display
+class NullTransport : public SH1106_Transport {
+    public:
+        virtual void begin() {}
+        virtual void sendCommands(const uint8_t *commands, uint8_t count) {}
+        virtual uint16_t sendData(uint8_t page, uint8_t column, const uint8_t *data, uint16_t count) { return count; }
+};
+
+
+static void setRandomClip(SH1106_OLED &oled, uint32_t &seed) {
+    if (nextRandom(seed) % 4 == 0) {
+        oled.resetClipRect();
+        return;
+    }
+
+    int16_t x1 = (int16_t)(nextRandom(seed) % 140) - 4;
+    int16_t y1 = (int16_t)(nextRandom(seed) % 72) - 4;
+    int16_t x2 = (int16_t)(nextRandom(seed) % 140) - 4;
+    int16_t y2 = (int16_t)(nextRandom(seed) % 72) - 4;
+    oled.setClipRect(x1, y1, x2, y2);
+}
+
+
+// Calls the primitives on the static type given, so on SH1106_OLED_Fixed they can be inlined
+template <class Display>
+static void drawPrimitive(Display &oled, uint32_t &seed) {
+    uint8_t x1 = nextRandom(seed) % 136;
+    uint8_t y1 = nextRandom(seed) % 72;
+    uint8_t x2 = nextRandom(seed) % 136;
+    uint8_t y2 = nextRandom(seed) % 72;
+    uint8_t size = nextRandom(seed) % 40;
+
+    switch (nextRandom(seed) % 6) {
+        case 0: oled.setPixel(x1, y1); break;
+        case 1: oled.clearPixel(x1, y1); break;
+        case 2: oled.invertPixel(x1, y1); break;
+        case 3: oled.drawHLine(x1, x2, y1); break;
+        case 4: oled.drawVLine(y1, y2, x1); break;
+        case 5: oled.drawCircle(x1, y1, size); break;
+    }
+}
+
+
+// Draws one shape of every kind the library offers on the static type given, so on SH1106_OLED_Fixed the shapes
+// built on its primitives are used
+template <class Display>
+static void drawShape(Display &oled, uint8_t kind, uint32_t &seed) {
+    static const uint8_t pattern[] = { 0x3C, 0x42, 0x81, 0xA5, 0x81, 0x99, 0x42, 0x3C, 0x0F, 0xF0, 0x0F, 0xF0 };
+    uint8_t x1 = nextRandom(seed) % 136;
+    uint8_t y1 = nextRandom(seed) % 72;
+    uint8_t x2 = nextRandom(seed) % 136;
+    uint8_t y2 = nextRandom(seed) % 72;
+    uint8_t size = nextRandom(seed) % 40;
+    uint16_t angle = nextRandom(seed) % 360;
+
+    switch (kind) {
+        case 0: oled.setPixel(x1, y1); break;
+        case 1: oled.clearPixel(x1, y1); break;
+        case 2: oled.invertPixel(x1, y1); break;
+        case 3: oled.drawHLine(x1, x2, y1); break;
+        case 4: oled.drawVLine(y1, y2, x1); break;
+        case 5: oled.drawLine(x1, y1, x2, y2); break;
+        case 6: oled.drawRect(x1, y1, size, size / 2); break;
+        case 7: oled.drawRectFill(x1, y1, size, size / 2); break;
+        case 8: oled.drawRoundedRect(x1, y1, size + 4, size / 2 + 4, size / 8); break;
+        case 9: oled.drawRoundedRectFill(x1, y1, size + 4, size / 2 + 4, size / 8); break;
+        case 10: oled.drawCircle(x1, y1, size); break;
+        case 11: oled.drawCircleFill(x1, y1, size); break;
+        case 12: oled.drawArc(x1, y1, size, (Corner)(size % 4)); break;
+        case 13: oled.drawArcFill(x1, y1, size, (Corner)(size % 4)); break;
+        case 14: oled.drawArcRaw(x1, y1, size, angle, angle + size * 8); break;
+        case 15: oled.drawArcThick(x1, y1, size, size / 4 + 1, angle, angle + 200); break;
+        case 16: oled.drawPie(x1, y1, size, angle, angle + 100); break;
+        case 17: oled.drawTriangle(x1, y1, x2, y2, x1 / 2 + 3, y2 / 2 + 1); break;
+        case 18: oled.drawTriangleFill(x1, y1, x2, y2, x1 / 2 + 3, y2 / 2 + 1); break;
+        case 19: oled.print("AB12:", x1, y1); break;
+        case 20: oled.drawBitmap(pattern, (int16_t)x1 - 4, (int16_t)y1 - 4, 6, 16, (BitmapMode)(size % 4), false); break;
+    }
+}
+
+static const uint8_t SHAPE_KINDS = 21;
+
+
+static bool sameState(SH1106_OLED &a, SH1106_OLED &b) {
+    return memcmp(a.getBuffer(), b.getBuffer(), a.getBufferSize()) == 0 && a.getDirtyBytes() == b.getDirtyBytes();
+}
+
+
+static void fillRandom(SH1106_OLED &oled, uint32_t &seed) {
+    uint8_t *buffer = oled.getBuffer();
+    for (uint16_t i = 0; i < oled.getBufferSize(); i++) {
+        buffer[i] = nextRandom(seed);
+    }
+}
+
+
+// Counts the pixels outside a random clip rectangle changed by shapes drawn inside it, over random buffer contents
+template <class Display>
+static uint32_t countOutsideChanges(Display &oled, uint32_t &seed) {
+    uint32_t outsideChanges = 0;
+    for (uint16_t i = 0; i < 2000; i++) {
+        uint8_t before[1024];
+        fillRandom(oled, seed);
+        memcpy(before, oled.getBuffer(), sizeof(before));
+
+        uint8_t x1 = nextRandom(seed) % 128;
+        uint8_t y1 = nextRandom(seed) % 64;
+        uint8_t x2 = min(127, x1 + (int)(nextRandom(seed) % 48));
+        uint8_t y2 = min(63, y1 + (int)(nextRandom(seed) % 32));
+        oled.setClipRect(x1, y1, x2, y2);
+        drawShape(oled, i % SHAPE_KINDS, seed);
+        oled.resetClipRect();
+
+        for (uint8_t y = 0; y < 64; y++) {
+            for (uint8_t x = 0; x < 128; x++) {
+                if (x >= x1 && x <= x2 && y >= y1 && y <= y2) {
+                    continue;
+                }
+                bool wasSet = before[x + (y / 8) * 128] & (1 << (y & 7));
+                outsideChanges += oled.getPixel(x, y) != wasSet;
+            }
+        }
+    }
+
+    return outsideChanges;
+}
+
+
+// Nanoseconds per call of a circle and a line pair on the static type given
+template <class Display>
+static double timeDrawing(Display &oled) {
+    const uint32_t rounds = 20000;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < rounds; i++) {
+        oled.drawCircle(64, 32, 10 + i % 20);
+        oled.drawHLine(i % 128, 127 - i % 128, i % 64);
+        oled.drawVLine(i % 64, 63 - i % 64, i % 128);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (double)rounds;
+}
+
+
+int main() {
+    hostReset();
+    SH1106_OLED_Fixed<128, 64> fixed(0x3C);
+    SH1106_OLED base(128, 64, 0x3D);
+    SH1106_OLED &fixedReference = fixed;
+    CHECK(fixed.init());
+    CHECK(base.init());
+
+    // The same random drawing under random clip rectangles, through a reference and on the derived type
+    uint32_t mismatches = 0;
+    uint32_t seed = 1;
+    for (uint16_t step = 0; step < 4000; step++) {
+        uint32_t clipSeed = seed;
+        setRandomClip(fixed, clipSeed);
+        setRandomClip(base, seed);
+
+        uint32_t shapeSeed = seed;
+        switch (step % 4) {
+            case 0:
+                drawRandomShape(fixedReference, shapeSeed);
+                drawRandomShape(base, seed);
+                break;
+
+            case 1:
+                drawPrimitive(fixed, shapeSeed);
+                drawPrimitive(base, seed);
+                break;
+
+            case 2:
+                drawShape(fixedReference, step % SHAPE_KINDS, shapeSeed);
+                drawShape(base, step % SHAPE_KINDS, seed);
+                break;
+
+            case 3:
+                drawShape(fixed, step % SHAPE_KINDS, shapeSeed);
+                drawShape(base, step % SHAPE_KINDS, seed);
+                break;
+        }
+        mismatches += !sameState(fixed, base);
+
+        if (step % 50 == 49) {
+            fixed.display();
+            base.display();
+        }
+    }
+    CHECK_EQUAL(0, mismatches);
+    metric("fixed_vs_base_mismatches", mismatches, "steps");
+
+    // Every shape leaves the pixels outside the clip rectangle alone, on both classes and through a reference
+    uint32_t outsideChanges = countOutsideChanges(fixed, seed);
+    outsideChanges += countOutsideChanges(fixedReference, seed);
+    outsideChanges += countOutsideChanges(base, seed);
+    CHECK_EQUAL(0, outsideChanges);
+    metric("pixels_changed_outside_clip", outsideChanges, "pixels");
+
+    // Constructing, initialising, drawing on and sending a fixed size display allocates nothing, where the runtime
+    // class allocates its buffer in init()
+    NullTransport transport;
+    countAllocations = true;
+    SH1106_OLED runtime(128, 64, transport);
+    CHECK(runtime.init());
+    countAllocations = false;
+    uint32_t runtimeAllocations = allocations;
+    CHECK_EQUAL(1, runtimeAllocations);
+
+    allocations = 0;
+    countAllocations = true;
+    {
+        SH1106_OLED_Fixed<128, 64> local(transport);
+        CHECK(local.init());
+        for (uint16_t i = 0; i < 1000; i++) {
+            drawShape(local, i % SHAPE_KINDS, seed);
+        }
+        local.display();
+    }
+    countAllocations = false;
+    CHECK_EQUAL(0, allocations);
+    metric("fixed_heap_allocations", allocations, "allocations");
+    metric("runtime_heap_allocations", runtimeAllocations, "allocations");
+    metric("fixed_object_bytes", sizeof(SH1106_OLED_Fixed<128, 64>), "bytes");
+    metric("runtime_object_and_heap_bytes", sizeof(SH1106_OLED) + runtime.getBufferSize(), "bytes");
+
+    fixed.resetClipRect();
+    base.resetClipRect();
+    metric("fixed_draw_host_ns", timeDrawing(fixed), "ns");
+    metric("fixed_reference_draw_host_ns", timeDrawing(fixedReference), "ns");
+    metric("base_draw_host_ns", timeDrawing(base), "ns");
+
+    return testResult();
+}
@@ -0,0 +1,82 @@
+// Character index lookups find the same glyphs as searching the code point ranges, fallbacks included
+
+#include "test.h"
+#include <chrono>
+#include "sparse_font.h"
+
+// Exposes glyph lookup, which is protected in the driver
+class FontProbe : public SH1106_OLED {
+    public:
+        FontProbe() : SH1106_OLED(128, 64, 0x3C) {}
+        using SH1106_OLED::findGlyph;
+};
+
+
+// Compares every 8-bit character's glyph between a font and a copy of it without its index
+static uint16_t countIndexMismatches(FontProbe &oled, const Font &font) {
+    Font searched = font;
+    searched.index = NULL;
+    uint16_t mismatches = 0;
+    for (uint16_t code = 0; code < 256; code++) {
+        const uint8_t *indexedGlyph = NULL;
+        const uint8_t *searchedGlyph = NULL;
+        oled.setFont(&font);
+        uint8_t indexedWidth = oled.findGlyph((char)code, &indexedGlyph);
+        oled.setFont(&searched);
+        uint8_t searchedWidth = oled.findGlyph((char)code, &searchedGlyph);
+        if (indexedWidth != searchedWidth || (searchedWidth && indexedGlyph != searchedGlyph)) {
+            mismatches++;
+        }
+    }
+
+    return mismatches;
+}
+
+
+// Nanoseconds per lookup on this host, over every printable ASCII character
+static double timeLookups(FontProbe &oled, const Font *font) {
+    oled.setFont(font);
+    volatile uint32_t sink = 0;
+    const uint32_t rounds = 20000;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (uint8_t code = ' '; code <= '~'; code++) {
+            const uint8_t *glyph;
+            sink = sink + oled.findGlyph(code, &glyph);
+        }
+    }
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return (double)elapsed / (rounds * ('~' - ' ' + 1));
+}
+
+
+int main() {
+    hostReset();
+    FontProbe oled;
+    oled.init();
+
+    CHECK_EQUAL(0, countIndexMismatches(oled, font_5x4_monospace));
+    CHECK_EQUAL(0, countIndexMismatches(oled, font_5x5_monospace));
+    CHECK_EQUAL(0, countIndexMismatches(oled, sparse));
+    CHECK(sparse.index != NULL);
+
+    // Lowercase falls back to uppercase, and missing characters to a space
+    const uint8_t *glyph;
+    const uint8_t *expected;
+    oled.setFont(&sparse);
+    CHECK_EQUAL(oled.findGlyph('A', &expected), oled.findGlyph('a', &glyph));
+    CHECK(glyph == expected);
+    CHECK_EQUAL(oled.findGlyph(' ', &expected), oled.findGlyph('B', &glyph));
+    CHECK(glyph == expected);
+    CHECK_EQUAL(oled.findGlyph(' ', &expected), oled.findGlyph((char)200, &glyph));
+    CHECK(glyph == expected);
+
+    Font searched = sparse;
+    searched.index = NULL;
+    metric("sparse_font_ranges", sparse.rangeCount, "ranges");
+    metric("sparse_font_index_bytes", sparse.indexCount, "bytes");
+    metric("sparse_font_indexed_host_ns_per_lookup", timeLookups(oled, &sparse), "ns");
+    metric("sparse_font_searched_host_ns_per_lookup", timeLookups(oled, &searched), "ns");
+
+    return testResult();
+}
@@ -0,0 +1,89 @@
+// Scaled text hits the glyph cache as often as a least recently used cache of its size should, and a repeatedly
+// printed counter string always hits once warm
+
+#include "test.h"
+
+// Hits of a least recently used cache with the given capacity over a sequence of glyphs
+static uint32_t simulateHits(const char *sequence, uint16_t repeats, uint8_t capacity) {
+    char entries[32];
+    uint32_t lastUsed[32];
+    uint8_t used = 0;
+    uint32_t tick = 0;
+    uint32_t hits = 0;
+    for (uint16_t repeat = 0; repeat < repeats; repeat++) {
+        for (const char *p = sequence; *p; p++) {
+            tick++;
+            uint8_t slot = 0;
+            bool found = false;
+            for (uint8_t i = 0; i < used; i++) {
+                if (entries[i] == *p) {
+                    slot = i;
+                    found = true;
+                }
+            }
+
+            if (found) {
+                hits++;
+            } else if (used < capacity) {
+                slot = used++;
+            } else {
+                for (uint8_t i = 1; i < used; i++) {
+                    slot = lastUsed[i] < lastUsed[slot] ? i : slot;
+                }
+            }
+
+            entries[slot] = *p;
+            lastUsed[slot] = tick;
+        }
+    }
+
+    return hits;
+}
+
+
+static void printRepeatedly(SH1106_OLED &oled, const char *text, uint16_t repeats) {
+    for (uint16_t i = 0; i < repeats; i++) {
+        oled.clear();
+        oled.print(text, 0, 10);
+    }
+}
+
+
+int main() {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    oled.init();
+    oled.setTextScale(2);
+
+    // Cached glyphs draw the same pixels as the first, uncached expansion
+    oled.print("12:34", 0, 10);
+    uint8_t expected[1024];
+    memcpy(expected, oled.getBuffer(), sizeof(expected));
+    oled.clear();
+    oled.print("12:34", 0, 10);
+    CHECK_EQUAL(0, memcmp(expected, oled.getBuffer(), sizeof(expected)));
+
+    static const char *texts[] = { "12:34", "23:59:58", "0123456789:", "-0123456789:" };
+    const uint16_t repeats = 100;
+    for (uint8_t i = 0; i < sizeof(texts) / sizeof(texts[0]); i++) {
+        SH1106_OLED probe(128, 64, 0x3C);
+        probe.init();
+        probe.setTextScale(2);
+        printRepeatedly(probe, texts[i], repeats);
+
+        uint32_t lookups = strlen(texts[i]) * repeats;
+        CHECK_EQUAL(lookups, probe.getGlyphCacheHits() + probe.getGlyphCacheMisses());
+        CHECK_EQUAL(simulateHits(texts[i], repeats, GLYPH_CACHE_SIZE), probe.getGlyphCacheHits());
+
+        // Every distinct glyph misses once, and nothing after that
+        CHECK_EQUAL(simulateHits(texts[i], 1, 32) + (lookups - strlen(texts[i])), probe.getGlyphCacheHits());
+
+        char name[64];
+        snprintf(name, sizeof(name), "hit_rate_%d_chars_%d_entries", (int)strlen(texts[i]), GLYPH_CACHE_SIZE);
+        metric(name, 100.0 * probe.getGlyphCacheHits() / lookups, "percent");
+        snprintf(name, sizeof(name), "hit_rate_%d_chars_4_entries", (int)strlen(texts[i]));
+        metric(name, 100.0 * simulateHits(texts[i], repeats, 4) / lookups, "percent");
+    }
+
+    return testResult();
+}
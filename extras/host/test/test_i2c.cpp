@@ -0,0 +1,117 @@
+// I2C framing throughput: bytes, transactions and bus time per full frame against the original per-byte display loop
+
+#include "test.h"
+
+// The display loop the library started from: a separate addressing transaction per page, then one Wire.write() per byte
+static void sendOriginalFrame(TwoWire &wire, const uint8_t *buffer) {
+    for (int i = 0; i < 8; i++) {
+        uint8_t cmd[] = { 0x00, (uint8_t)(0xB0 + i), 0x10, 0x02 };
+        wire.beginTransmission(0x3C);
+        wire.write(cmd, 4);
+        wire.endTransmission();
+
+        wire.beginTransmission(0x3C);
+        wire.write(0x40);
+        uint8_t bytesWritten = 1;
+        for (int j = 0; j < 128; j++) {
+            wire.write(buffer[j + (i * 128)]);
+            bytesWritten++;
+            if (bytesWritten == WIRE_MAX) {
+                wire.endTransmission(false);
+                wire.beginTransmission(0x3C);
+                wire.write(0x40);
+                bytesWritten = 1;
+            }
+        }
+        wire.endTransmission(true);
+    }
+}
+
+
+static size_t countBytes(const std::vector<WireTransaction> &log) {
+    size_t bytes = 0;
+    for (size_t i = 0; i < log.size(); i++) {
+        bytes += log[i].bytes.size() + 1;
+    }
+
+    return bytes;
+}
+
+
+int main() {
+    CHECK_EQUAL(BUFFER_LENGTH, WIRE_MAX);
+
+    hostReset();
+    TwoWire bus;
+    SH1106_I2C i2c(0x3C, bus);
+    SH1106_OLED oled(128, 64, i2c);
+    SH1106_Model model;
+    oled.init();
+    uint32_t seed = 7;
+    for (uint8_t i = 0; i < 40; i++) {
+        drawRandomShape(oled, seed);
+    }
+    oled.display();
+    model.receive(bus);
+    bus.clearLog();
+
+    // Full frame through the driver
+    uint32_t bytesBefore = oled.getBytesSent();
+    uint32_t transactionsBefore = oled.getTransactionCount();
+    oled.invert();
+    oled.invert();
+    oled.display();
+    model.receive(bus);
+    std::vector<WireTransaction> frame = bus.getLog();
+    uint64_t frameMicros = bus.getBusMicros();
+    CHECK_EQUAL(0, countPanelErrors(model, oled));
+    CHECK_EQUAL(0, model.overflowBytes);
+
+    // Every transaction fits the Wire buffer and carries data, with address commands only where the column does not follow on
+    uint32_t addressed = 0;
+    uint32_t dataBytes = 0;
+    for (size_t i = 0; i < frame.size(); i++) {
+        const std::vector<uint8_t> &bytes = frame[i].bytes;
+        CHECK(bytes.size() <= BUFFER_LENGTH);
+        size_t header = 0;
+        while (bytes[header] == SH1106_CONTROL_COMMAND) {
+            header += 2;
+        }
+        CHECK_EQUAL(SH1106_CONTROL_DATA_STREAM, bytes[header]);
+        addressed += header > 0;
+        dataBytes += bytes.size() - header - 1;
+    }
+    CHECK_EQUAL(8, addressed);
+    CHECK_EQUAL(1024, dataBytes);
+
+    // The driver's own counters agree with the bus, which also carries an address byte per transaction
+    CHECK_EQUAL(countBytes(frame) - frame.size(), oled.getBytesSent() - bytesBefore);
+    CHECK_EQUAL(frame.size(), oled.getTransactionCount() - transactionsBefore);
+
+    // The original loop on the same bus model
+    TwoWire originalBus;
+    SH1106_Model originalModel;
+    originalBus.setClock(400000);
+    sendOriginalFrame(originalBus, oled.getBuffer());
+    originalModel.receive(originalBus);
+    for (uint8_t page = 0; page < 8; page++) {
+        for (uint8_t column = 0; column < 128; column++) {
+            CHECK_EQUAL(oled.getBuffer()[column + page * 128], originalModel.getRam(page, column + 2));
+        }
+    }
+
+    size_t frameBytes = countBytes(frame);
+    size_t originalBytes = countBytes(originalBus.getLog());
+    CHECK(frame.size() < originalBus.getLog().size());
+    CHECK(frameBytes < originalBytes);
+    CHECK(frameMicros < originalBus.getBusMicros());
+
+    metric("original_bytes_per_frame", originalBytes, "bytes");
+    metric("original_transactions_per_frame", originalBus.getLog().size(), "transactions");
+    metric("original_bus_time_per_frame", originalBus.getBusMicros(), "us");
+    metric("bytes_per_frame", frameBytes, "bytes");
+    metric("transactions_per_frame", frame.size(), "transactions");
+    metric("bus_time_per_frame", frameMicros, "us");
+
+    return testResult();
+}
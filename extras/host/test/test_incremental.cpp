@@ -0,0 +1,83 @@
+// Incremental flush: each pollDisplay() is bounded to one bus transaction, and drawing between polls is never lost
+
+#include "test.h"
+
+int main() {
+    hostReset();
+    TwoWire bus;
+    SH1106_I2C i2c(0x3C, bus);
+    SH1106_OLED oled(128, 64, i2c);
+    SH1106_Model model;
+    oled.init();
+    model.receive(bus);
+
+    // A full frame, one poll at a time
+    oled.invert();
+    size_t logged = bus.getLog().size();
+    uint64_t start = hostNanos;
+    oled.beginDisplay();
+    CHECK_EQUAL(logged, bus.getLog().size());
+    CHECK(oled.isBusy());
+
+    uint32_t polls = 0;
+    uint64_t longestPoll = 0;
+    while (oled.isBusy()) {
+        uint64_t before = hostNanos;
+        logged = bus.getLog().size();
+        oled.pollDisplay();
+        polls++;
+        CHECK(bus.getLog().size() - logged <= 1);
+        longestPoll = max(longestPoll, hostNanos - before);
+    }
+    uint64_t frameTime = hostNanos - start;
+    model.receive(bus);
+    CHECK_EQUAL(0, countPanelErrors(model, oled));
+    CHECK(!oled.pollDisplay());
+
+    // One transaction of BUFFER_LENGTH bytes plus the address byte, start and stop at 400 kHz
+    uint64_t transactionLimit = ((BUFFER_LENGTH + 1) * 9 + 2) * 1000000000ULL / 400000;
+    CHECK(longestPoll <= transactionLimit);
+    metric("polls_per_full_frame", polls, "polls");
+    metric("longest_poll", longestPoll / 1000.0, "us");
+    metric("blocking_full_frame", frameTime / 1000.0, "us");
+
+    // Drawing between polls, including over parts already sent and parts still to send
+    uint32_t seed = 3;
+    uint32_t errors = 0;
+    for (uint8_t frame = 0; frame < 50; frame++) {
+        for (uint8_t i = 0; i < 4; i++) {
+            drawRandomShape(oled, seed);
+        }
+
+        oled.beginDisplay();
+        while (oled.pollDisplay()) {
+            if (nextRandom(seed) % 3 == 0) {
+                drawRandomShape(oled, seed);
+            }
+        }
+
+        // Whatever was drawn during the transfer goes out with the next one
+        oled.display();
+        model.receive(bus);
+        errors += countPanelErrors(model, oled);
+    }
+    CHECK_EQUAL(0, errors);
+
+    // Starting a transfer while one is in progress finishes the first
+    oled.invert();
+    oled.beginDisplay();
+    oled.pollDisplay();
+    oled.setPixel(1, 1);
+    oled.beginDisplay();
+    while (oled.pollDisplay());
+    model.receive(bus);
+    CHECK_EQUAL(0, countPanelErrors(model, oled));
+
+    // Nothing dirty means nothing to send
+    logged = bus.getLog().size();
+    oled.beginDisplay();
+    CHECK(!oled.isBusy());
+    CHECK_EQUAL(logged, bus.getLog().size());
+
+    return testResult();
+}
@@ -0,0 +1,185 @@
+// drawLine against a reference Bresenham rasteriser. Lines on screen stay within half a pixel of the ideal line, and
+// lines running off the screen light exactly the on-screen pixels of the same line drawn without clipping
+
+#include "test.h"
+
+struct Pixel {
+    int x;
+    int y;
+};
+
+
+// Classic integer Bresenham over the whole line, without clipping
+static std::vector<Pixel> referenceLine(int x1, int y1, int x2, int y2) {
+    std::vector<Pixel> pixels;
+    int dx = abs(x2 - x1);
+    int dy = -abs(y2 - y1);
+    int sx = x1 < x2 ? 1 : -1;
+    int sy = y1 < y2 ? 1 : -1;
+    int error = dx + dy;
+    while (true) {
+        Pixel p = { x1, y1 };
+        pixels.push_back(p);
+        if (x1 == x2 && y1 == y2) {
+            break;
+        }
+        int e2 = 2 * error;
+        if (e2 >= dy) {
+            error += dy;
+            x1 += sx;
+        }
+        if (e2 <= dx) {
+            error += dx;
+            y1 += sy;
+        }
+    }
+
+    return pixels;
+}
+
+
+// The same walk the driver uses, starting the error term at half the major distance, over the whole line without clipping
+static std::vector<Pixel> walkLine(int x1, int y1, int x2, int y2) {
+    std::vector<Pixel> pixels;
+    int dx = abs(x2 - x1);
+    int dy = abs(y2 - y1);
+    int sx = x2 >= x1 ? 1 : -1;
+    int sy = y2 >= y1 ? 1 : -1;
+    bool xMajor = dx >= dy;
+    int major = xMajor ? dx : dy;
+    int minor = xMajor ? dy : dx;
+    int error = major / 2;
+    for (int i = 0; i <= major; i++) {
+        Pixel p = { x1, y1 };
+        pixels.push_back(p);
+        error -= minor;
+        if (error < 0) {
+            error += major;
+            if (xMajor) {
+                y1 += sy;
+            } else {
+                x1 += sx;
+            }
+        }
+        if (xMajor) {
+            x1 += sx;
+        } else {
+            y1 += sy;
+        }
+    }
+
+    return pixels;
+}
+
+
+// Counts on-screen pixels of a reference that are missing from the buffer, and lit pixels that are not in the reference
+static void compare(SH1106_OLED &oled, const std::vector<Pixel> &reference, uint32_t &missing, uint32_t &extra) {
+    uint32_t lit = 0;
+    for (uint8_t y = 0; y < 64; y++) {
+        for (uint8_t x = 0; x < 128; x++) {
+            lit += oled.getPixel(x, y);
+        }
+    }
+
+    uint32_t onScreen = 0;
+    missing = 0;
+    for (size_t i = 0; i < reference.size(); i++) {
+        const Pixel &p = reference[i];
+        if (p.x < 128 && p.y < 64) {
+            onScreen++;
+            missing += !oled.getPixel(p.x, p.y);
+        }
+    }
+    extra = lit - (onScreen - missing);
+}
+
+
+// Distance along the minor axis from a pixel to the ideal line through the end points, in pixels
+static double minorDistance(int x1, int y1, int x2, int y2, int x, int y) {
+    if (abs(x2 - x1) >= abs(y2 - y1)) {
+        return x2 == x1 ? fabs((double)(y - y1)) : fabs(y - (y1 + (double)(y2 - y1) * (x - x1) / (x2 - x1)));
+    }
+
+    return fabs(x - (x1 + (double)(x2 - x1) * (y - y1) / (y2 - y1)));
+}
+
+
+int main() {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    oled.init();
+
+    uint32_t seed = 23;
+    uint32_t onScreenLines = 0;
+    uint32_t walkDifferences = 0;
+    uint32_t exactLines = 0;
+    uint32_t tieOnlyDifferences = 0;
+    uint32_t badPixels = 0;
+    uint32_t clippedLines = 0;
+    uint32_t clippedDifferences = 0;
+
+    for (uint32_t i = 0; i < 20000; i++) {
+        bool clipped = i % 2;
+        int x1 = nextRandom(seed) % (clipped ? 256 : 128);
+        int y1 = nextRandom(seed) % (clipped ? 256 : 64);
+        int x2 = nextRandom(seed) % (clipped ? 256 : 128);
+        int y2 = nextRandom(seed) % (clipped ? 256 : 64);
+
+        oled.clear();
+        oled.drawLine(x1, y1, x2, y2);
+        uint32_t missing;
+        uint32_t extra;
+        compare(oled, walkLine(x1, y1, x2, y2), missing, extra);
+
+        if (clipped) {
+            // Exactly the on-screen part of the unclipped line
+            clippedLines++;
+            clippedDifferences += missing + extra;
+            continue;
+        }
+
+        onScreenLines++;
+        walkDifferences += missing + extra;
+
+        // Within half a pixel of the ideal line, and the same as classic Bresenham except where it rounds a tie the other way
+        for (uint8_t y = 0; y < 64; y++) {
+            for (uint8_t x = 0; x < 128; x++) {
+                badPixels += oled.getPixel(x, y) && minorDistance(x1, y1, x2, y2, x, y) > 0.5 + 1e-9;
+            }
+        }
+
+        std::vector<Pixel> reference = referenceLine(x1, y1, x2, y2);
+        compare(oled, reference, missing, extra);
+        if (missing == 0 && extra == 0) {
+            exactLines++;
+        } else {
+            bool tiesOnly = true;
+            for (size_t j = 0; j < reference.size(); j++) {
+                const Pixel &p = reference[j];
+                if (!oled.getPixel(p.x, p.y) && fabs(minorDistance(x1, y1, x2, y2, p.x, p.y) - 0.5) > 1e-9) {
+                    tiesOnly = false;
+                }
+            }
+            tieOnlyDifferences += tiesOnly;
+        }
+    }
+
+    CHECK_EQUAL(0, walkDifferences);
+    CHECK_EQUAL(0, badPixels);
+    CHECK_EQUAL(onScreenLines, exactLines + tieOnlyDifferences);
+    CHECK_EQUAL(0, clippedDifferences);
+    metric("on_screen_lines", onScreenLines, "lines");
+    metric("on_screen_same_as_classic_bresenham", exactLines, "lines");
+    metric("on_screen_tie_rounding_only", tieOnlyDifferences, "lines");
+    metric("clipped_lines", clippedLines, "lines");
+    metric("clipped_pixel_differences", clippedDifferences, "pixels");
+
+    // Lines longer than 127 pixels, which overflowed the original int8_t distances
+    oled.clear();
+    oled.drawLine(0, 0, 127, 63);
+    CHECK(oled.getPixel(0, 0));
+    CHECK(oled.getPixel(127, 63));
+    CHECK(oled.getPixel(64, 32) || oled.getPixel(64, 31));
+
+    return testResult();
+}
@@ -0,0 +1,155 @@
+// SH1106_Manager drives displays behind multiplexer channels and on the main bus, and every command reaches the right
+// panel: frames from update(), and contrast fades, sleep() and wake() sent outside it while another display is mid-transfer.
+// Settings changed without drawing are sent too.
+
+#include "test.h"
+#include "SH1106_Manager.h"
+
+#define MUX_ADDRESS 0x70
+#define PANELS 3
+
+// Panels 0 and 1 are at 0x3C behind mux channels 0 and 3, panel 2 is at 0x3D on the main bus
+static const uint8_t panelChannels[PANELS] = { 0, 3, NO_MUX_CHANNEL };
+static const uint8_t panelAddresses[PANELS] = { 0x3C, 0x3C, 0x3D };
+
+// Delivers the logged bus traffic to the panels that would see it, following the channels the multiplexer has open
+struct MuxBus {
+    SH1106_Model models[PANELS];
+    uint8_t openChannels;
+    size_t read;
+    uint32_t muxWrites;
+    uint32_t misrouted;
+
+    MuxBus() : openChannels(0), read(0), muxWrites(0), misrouted(0) {}
+
+    void receive() {
+        const std::vector<WireTransaction> &log = Wire.getLog();
+        for (; read < log.size(); read++) {
+            const WireTransaction &transaction = log[read];
+            if (transaction.address == MUX_ADDRESS) {
+                openChannels = transaction.bytes.empty() ? openChannels : transaction.bytes[0];
+                muxWrites++;
+                continue;
+            }
+
+            uint8_t receivers = 0;
+            for (uint8_t i = 0; i < PANELS; i++) {
+                bool reachable = panelChannels[i] == NO_MUX_CHANNEL || (openChannels & (0x01 << panelChannels[i]));
+                if (reachable && panelAddresses[i] == transaction.address) {
+                    models[i].receive(transaction.bytes.data(), transaction.bytes.size());
+                    receivers++;
+                }
+            }
+            misrouted += receivers != 1;
+        }
+    }
+};
+
+
+// Draws different content on each display
+static void drawScene(SH1106_OLED *oleds[], uint8_t frame) {
+    for (uint8_t i = 0; i < PANELS; i++) {
+        oleds[i]->clear();
+        oleds[i]->drawCircleFill(20 + i * 40 + frame, 32, 10 + i * 4);
+        oleds[i]->print("PANEL", 4, 4 + i * 8);
+    }
+}
+
+
+int main() {
+    hostReset();
+    SH1106_OLED a(128, 64, 0x3C);
+    SH1106_OLED b(128, 64, 0x3C);
+    SH1106_OLED c(128, 64, 0x3D);
+    SH1106_OLED *oleds[PANELS] = { &a, &b, &c };
+    SH1106_Manager manager(MUX_ADDRESS);
+    for (uint8_t i = 0; i < PANELS; i++) {
+        CHECK_EQUAL(i, manager.addDisplay(*oleds[i], 0, panelChannels[i]));
+    }
+
+    MuxBus bus;
+    CHECK(manager.begin());
+    bus.receive();
+    for (uint8_t i = 0; i < PANELS; i++) {
+        CHECK(bus.models[i].on);
+        CHECK(bus.models[i].chargePump);
+    }
+
+    drawScene(oleds, 0);
+    manager.displayAll();
+    bus.receive();
+    uint32_t errors = 0;
+    for (uint8_t i = 0; i < PANELS; i++) {
+        errors += countPanelErrors(bus.models[i], *oleds[i]);
+    }
+
+    // Fade panel 0 and put panel 1 to sleep and back while the manager is part way through sending each frame
+    uint8_t contrastSteps = 0;
+    uint8_t lastContrast = bus.models[0].contrast;
+    a.fadeContrast(0x10, 200);
+    for (uint8_t frame = 1; frame <= 20; frame++) {
+        drawScene(oleds, frame);
+        for (uint8_t step = 0; step < 8; step++) {
+            manager.update(1);
+            delay(5);
+            a.updateContrastFade();
+            if (frame == 5 && step == 3) {
+                b.sleep();
+            }
+            if (frame == 10 && step == 3) {
+                bus.receive();
+                CHECK(!bus.models[1].on);
+                CHECK(bus.models[0].on);
+                CHECK(bus.models[2].on);
+                b.wake();
+            }
+
+            bus.receive();
+            if (bus.models[0].contrast != lastContrast) {
+                lastContrast = bus.models[0].contrast;
+                contrastSteps++;
+            }
+        }
+
+        manager.displayAll();
+        bus.receive();
+        for (uint8_t i = 0; i < PANELS; i++) {
+            // A sleeping panel is dark, whatever its RAM holds
+            CHECK_EQUAL(!oleds[i]->isAsleep(), bus.models[i].on);
+            if (!oleds[i]->isAsleep()) {
+                errors += countPanelErrors(bus.models[i], *oleds[i]);
+            }
+        }
+    }
+    CHECK(!a.updateContrastFade());
+    CHECK_EQUAL(0x10, bus.models[0].contrast);
+    CHECK_EQUAL(0x10, a.getContrast());
+    CHECK_EQUAL(0xFF, bus.models[1].contrast);
+    CHECK_EQUAL(0xFF, bus.models[2].contrast);
+    CHECK(contrastSteps > 1);
+    CHECK(bus.models[1].on);
+
+    // Settings changed without drawing anything are sent by update() alone
+    c.setInverse(true);
+    b.setStartLine(8);
+    CHECK_EQUAL(0, c.getDirtyBytes());
+    CHECK(c.hasPendingSettings());
+    while (manager.update(1));
+    bus.receive();
+    CHECK(bus.models[2].inverse);
+    CHECK(!c.hasPendingSettings());
+    CHECK(!b.hasPendingSettings());
+    for (uint8_t i = 0; i < PANELS; i++) {
+        errors += countPanelErrors(bus.models[i], *oleds[i]);
+    }
+
+    CHECK_EQUAL(0, errors);
+    CHECK_EQUAL(0, bus.misrouted);
+    metric("wrong_pixels", errors, "pixels");
+    metric("misrouted_transactions", bus.misrouted, "transactions");
+    metric("contrast_steps_on_faded_panel", contrastSteps, "commands");
+    metric("mux_writes", bus.muxWrites, "transactions");
+    metric("panel_transactions", bus.models[0].transactions + bus.models[1].transactions + bus.models[2].transactions, "transactions");
+
+    return testResult();
+}
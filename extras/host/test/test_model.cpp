@@ -0,0 +1,51 @@
+// Smoke test for the host build: the driver initialises the modelled controller, and drawn pixels reach the panel
+
+#include "test.h"
+
+int main() {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    SH1106_Model model(128, 64, 2);
+
+    CHECK(oled.init());
+    model.receive(Wire);
+    CHECK(model.on);
+    CHECK(model.chargePump);
+    CHECK_EQUAL(63, model.multiplex);
+    CHECK_EQUAL(0, model.overflowBytes);
+    CHECK_EQUAL(0, countPanelErrors(model, oled));
+
+    oled.drawRect(10, 5, 40, 20);
+    oled.print("HELLO", 60, 40);
+    oled.display();
+    model.receive(Wire);
+    CHECK(model.getPanelPixel(10, 5));
+    CHECK(!model.getPanelPixel(11, 6));
+    CHECK_EQUAL(0, countPanelErrors(model, oled));
+
+    // The control byte framing decodes the same either way round
+    SH1106_Model framing;
+    const uint8_t single[] = { 0x80, 0xB3, 0x80, 0x12, 0x80, 0x04, 0x40, 0x11, 0x22 };
+    const uint8_t stream[] = { 0x00, 0xB3, 0x12, 0x06 };
+    framing.receive(single, sizeof(single));
+    CHECK_EQUAL(0x11, framing.getRam(3, 0x24));
+    CHECK_EQUAL(0x22, framing.getRam(3, 0x25));
+    framing.receive(stream, sizeof(stream));
+    CHECK_EQUAL(3, framing.page);
+    CHECK_EQUAL(0x26, framing.column);
+    CHECK_EQUAL(2, framing.transactions);
+
+    // Flipped panels reach the far end of RAM and still show the buffer the right way round
+    hostReset();
+    SH1106_OLED flipped(128, 32, 0x3C, ORIENTATION_FLIPPED);
+    SH1106_Model flippedModel(128, 32, 2);
+    CHECK(flipped.init());
+    flipped.drawLine(0, 0, 127, 31);
+    flipped.print("AB", 3, 20);
+    flipped.display();
+    flippedModel.receive(Wire);
+    CHECK_EQUAL(31, flippedModel.multiplex);
+    CHECK_EQUAL(0, countPanelErrors(flippedModel, flipped));
+
+    return testResult();
+}
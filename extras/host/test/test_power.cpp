@@ -0,0 +1,173 @@
+// init() sends its configuration as one command stream and turns the display on as soon as the datasheet allows, and
+// sleep() and wake() keep the display RAM so waking needs no resend. Times are on the virtual clock, which advances
+// with the datasheet delays and the bus time of each I2C transaction at 400 kHz.
+
+#include "test.h"
+
+// The init() the library started from: one transaction per command, with a fixed 100 ms delay before and after
+class LegacyInitOLED : public SH1106_OLED {
+    public:
+        LegacyInitOLED() : SH1106_OLED(128, 64, 0x3C) {}
+
+        void legacyInit(uint8_t *storage) {
+            setBuffer(storage);
+            memset(buffer, 0x00, bufferSize);
+            markAllDirty();
+            ramColumnOffset = columnOffset;
+
+            transport->begin();
+            delay(100);
+
+            sendCommand(0xAE);
+            sendDualCommand(0xD5, 0x80);
+            sendDualCommand(0xA8, height - 1);
+            sendDualCommand(0xD3, 0x00);
+            sendCommand(0x40);
+            sendDualCommand(0xAD, 0x8B);
+            sendCommand(0xA1);
+            sendCommand(0xC8);
+            sendDualCommand(0xDA, 0x12);
+            sendDualCommand(0x81, 0xFF);
+            sendDualCommand(0xD9, 0x1F);
+            sendDualCommand(0xDB, 0x40);
+            sendCommand(0x33);
+            sendCommand(0xA6);
+            sendCommand(0xA4);
+
+            delay(100);
+            display();
+            sendCommand(0xAF);
+        }
+};
+
+
+static void drawScene(SH1106_OLED &oled) {
+    oled.drawCircleFill(30, 30, 20);
+    oled.drawRect(70, 10, 40, 30);
+    oled.print("READY", 70, 50);
+}
+
+
+// Counts the transactions that carry only commands
+static uint32_t countCommandTransactions() {
+    const std::vector<WireTransaction> &log = Wire.getLog();
+    uint32_t count = 0;
+    for (size_t i = 0; i < log.size(); i++) {
+        bool hasData = false;
+        for (size_t j = 0; j < log[i].bytes.size(); j++) {
+            bool continuation = log[i].bytes[j] & 0x80;
+            if (log[i].bytes[j] & 0x40) {
+                hasData = true;
+            }
+            if (!continuation) {
+                break;
+            }
+            j++;
+        }
+        count += !hasData;
+    }
+
+    return count;
+}
+
+
+int main() {
+    // Boot with the batched init
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    SH1106_Model model;
+    CHECK(oled.init());
+    uint32_t initMs = millis();
+    uint32_t initTransactions = oled.getTransactionCount();
+    uint32_t initCommandTransactions = countCommandTransactions();
+    drawScene(oled);
+    oled.display();
+    uint32_t firstFrameMs = millis();
+    model.receive(Wire);
+    CHECK(model.on);
+    CHECK(model.chargePump);
+    CHECK_EQUAL(63, model.multiplex);
+    CHECK_EQUAL(0, countPanelErrors(model, oled));
+    // Configuration and display on; the RAM clearing flush is data
+    CHECK_EQUAL(2, initCommandTransactions);
+    CHECK(initMs >= SH1106_CHARGE_PUMP_DELAY);
+
+    // The same boot with the original init, for comparison
+    hostReset();
+    static uint8_t legacyBuffer[1024];
+    LegacyInitOLED legacy;
+    SH1106_Model legacyModel;
+    legacy.legacyInit(legacyBuffer);
+    uint32_t legacyInitMs = millis();
+    uint32_t legacyInitTransactions = legacy.getTransactionCount();
+    uint32_t legacyCommandTransactions = countCommandTransactions();
+    drawScene(legacy);
+    legacy.display();
+    uint32_t legacyFirstFrameMs = millis();
+    legacyModel.receive(Wire);
+    CHECK_EQUAL(0, countPanelErrors(legacyModel, legacy));
+    CHECK(firstFrameMs < legacyFirstFrameMs);
+
+    metric("init_ms", initMs, "ms");
+    metric("init_transactions", initTransactions, "transactions");
+    metric("init_command_transactions", initCommandTransactions, "transactions");
+    metric("first_frame_ms", firstFrameMs, "ms");
+    metric("legacy_init_ms", legacyInitMs, "ms");
+    metric("legacy_init_transactions", legacyInitTransactions, "transactions");
+    metric("legacy_init_command_transactions", legacyCommandTransactions, "transactions");
+    metric("legacy_first_frame_ms", legacyFirstFrameMs, "ms");
+
+    // Sleep turns the display and charge pump off; waking sends no data when nothing was drawn, because RAM is kept
+    hostReset();
+    CHECK(oled.init());
+    drawScene(oled);
+    oled.display();
+    SH1106_Model sleepModel;
+    sleepModel.receive(Wire);
+    oled.sleep();
+    sleepModel.receive(Wire);
+    CHECK(!sleepModel.on);
+    CHECK(!sleepModel.chargePump);
+    CHECK(oled.isAsleep());
+
+    delay(1000);
+    uint32_t dataBefore = sleepModel.dataBytes;
+    uint32_t wakeStart = millis();
+    oled.wake();
+    uint32_t wakeMs = millis() - wakeStart;
+    sleepModel.receive(Wire);
+    CHECK(sleepModel.on);
+    CHECK(!oled.isAsleep());
+    uint32_t wakeDataBytes = sleepModel.dataBytes - dataBefore;
+    CHECK_EQUAL(0, wakeDataBytes);
+    CHECK_EQUAL(0, countPanelErrors(sleepModel, oled));
+    CHECK(wakeMs >= SH1106_CHARGE_PUMP_DELAY);
+
+    // Keeping the charge pump on makes waking immediate
+    oled.sleep(true);
+    sleepModel.receive(Wire);
+    CHECK(!sleepModel.on);
+    CHECK(sleepModel.chargePump);
+    delay(1000);
+    wakeStart = millis();
+    oled.wake();
+    uint32_t fastWakeMs = millis() - wakeStart;
+    sleepModel.receive(Wire);
+    CHECK(sleepModel.on);
+    CHECK_EQUAL(dataBefore, sleepModel.dataBytes);
+    CHECK(fastWakeMs < 1);
+
+    // Drawing while asleep is sent during the wake, while the charge pump settles
+    oled.sleep();
+    oled.drawCircle(100, 30, 12);
+    oled.wake();
+    sleepModel.receive(Wire);
+    CHECK(sleepModel.dataBytes > dataBefore);
+    CHECK_EQUAL(0, countPanelErrors(sleepModel, oled));
+
+    metric("wake_ms", wakeMs, "ms");
+    metric("wake_keep_charge_pump_ms", fastWakeMs, "ms");
+    metric("wake_data_bytes", wakeDataBytes, "bytes");
+
+    return testResult();
+}
@@ -0,0 +1,51 @@
+// Printing text allocates nothing on the heap, and every string form draws the same pixels
+
+#include "test.h"
+#include "allocations.h"
+
+int main() {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    oled.init();
+
+    static const char text[] = "Mixed case 0123456789 text that runs off the right edge";
+    String string(text);
+    uint8_t expected[1024];
+    oled.print(text, 3, 5);
+    memcpy(expected, oled.getBuffer(), sizeof(expected));
+
+    // The counter sees a heap copy of a string, so a zero below means nothing was allocated
+    countAllocations = true;
+    String copy(text);
+    char *block = (char *)malloc(16);
+    countAllocations = false;
+    free(block);
+    CHECK(allocations >= 2);
+    allocations = 0;
+
+    countAllocations = true;
+    for (uint16_t i = 0; i < 1000; i++) {
+        oled.clear();
+        oled.print(text, 3, 5);
+        oled.print(F("FLASH"), 0, 40);
+        oled.print(string, 60, 50);
+        oled.printBox("Boxed text that wraps", 10, 20, 60, 20, ALIGN_CENTRE);
+        oled.setCursor(0, 58);
+        oled.print(i);
+        oled.println(-12345L);
+        oled.print('x');
+    }
+    countAllocations = false;
+    CHECK_EQUAL(0, allocations);
+    metric("print_heap_allocations", allocations, "allocations");
+
+    // The pointer, flash and String forms draw the same pixels
+    oled.clear();
+    oled.print(F("Mixed case 0123456789 text that runs off the right edge"), 3, 5);
+    CHECK_EQUAL(0, memcmp(expected, oled.getBuffer(), sizeof(expected)));
+    oled.clear();
+    oled.print(string, 3, 5);
+    CHECK_EQUAL(0, memcmp(expected, oled.getBuffer(), sizeof(expected)));
+
+    return testResult();
+}
@@ -0,0 +1,181 @@
+// Bitmaps compressed by extras/bitmap2rle.py decode to the source images, and draw exactly like the raw bitmaps in
+// every blend mode and position
+
+#include "test.h"
+#include <chrono>
+#include <string>
+#include <vector>
+#include "battery_rle.h"
+#include "wifi_rle.h"
+#include "gauge_rle.h"
+#include "noise_rle.h"
+#include "splash_rle.h"
+
+struct Image {
+    const char *name;
+    const uint8_t *compressed;
+    size_t compressedSize;
+    uint8_t width;
+    uint8_t height;
+    std::vector<bool> lit;
+    std::vector<uint8_t> packed;
+};
+
+
+// Reads a P1 or P4 PBM file. PBM stores 1 for black, and light pixels are lit.
+static bool loadPbm(Image &image) {
+    std::string path = std::string(TEST_IMAGE_DIR) + "/" + image.name + ".pbm";
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        data.push_back(c);
+    }
+    fclose(file);
+
+    // Magic, width and height, skipping comments
+    size_t i = 0;
+    std::string tokens[3];
+    for (uint8_t token = 0; token < 3; token++) {
+        while (i < data.size() && (isspace(data[i]) || data[i] == '#')) {
+            if (data[i] == '#') {
+                while (i < data.size() && data[i] != '\n') {
+                    i++;
+                }
+            }
+            i++;
+        }
+        while (i < data.size() && !isspace(data[i])) {
+            tokens[token] += (char)data[i++];
+        }
+    }
+
+    image.width = atoi(tokens[1].c_str());
+    image.height = atoi(tokens[2].c_str());
+    image.lit.assign(image.width * image.height, false);
+    if (tokens[0] == "P4") {
+        i++;
+        uint16_t stride = (image.width + 7) / 8;
+        for (uint16_t y = 0; y < image.height; y++) {
+            for (uint16_t x = 0; x < image.width; x++) {
+                image.lit[x + y * image.width] = !((data[i + y * stride + x / 8] >> (7 - x % 8)) & 1);
+            }
+        }
+    } else {
+        uint32_t pixel = 0;
+        for (; i < data.size() && pixel < image.lit.size(); i++) {
+            if (data[i] == '0' || data[i] == '1') {
+                image.lit[pixel++] = data[i] == '0';
+            }
+        }
+    }
+
+    // Page-packed copy for drawBitmap, top row in bit 0
+    uint8_t pages = (image.height + 7) / 8;
+    image.packed.assign(image.width * pages, 0);
+    for (uint16_t y = 0; y < image.height; y++) {
+        for (uint16_t x = 0; x < image.width; x++) {
+            if (image.lit[x + y * image.width]) {
+                image.packed[x + (y / 8) * image.width] |= 1 << (y & 7);
+            }
+        }
+    }
+
+    return true;
+}
+
+
+static void fillRandom(SH1106_OLED &oled, uint32_t seed) {
+    uint8_t *buffer = oled.getBuffer();
+    for (uint16_t i = 0; i < 1024; i++) {
+        buffer[i] = nextRandom(seed);
+    }
+}
+
+
+int main() {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    oled.init();
+
+    Image images[] = {
+        { "battery", battery_rle, sizeof(battery_rle) },
+        { "wifi", wifi_rle, sizeof(wifi_rle) },
+        { "gauge", gauge_rle, sizeof(gauge_rle) },
+        { "noise", noise_rle, sizeof(noise_rle) },
+        { "splash", splash_rle, sizeof(splash_rle) }
+    };
+
+    uint32_t totalRaw = 0;
+    uint32_t totalCompressed = 0;
+    for (uint8_t n = 0; n < sizeof(images) / sizeof(images[0]); n++) {
+        Image &image = images[n];
+        CHECK(loadPbm(image));
+        CHECK_EQUAL(image.width, pgm_read_byte(&image.compressed[0]));
+        CHECK_EQUAL(image.height, pgm_read_byte(&image.compressed[1]));
+
+        // The decoded image lights exactly the light pixels of the source
+        oled.clear();
+        oled.drawCompressedBitmap(image.compressed, 0, 0);
+        uint32_t wrongPixels = 0;
+        for (uint8_t y = 0; y < 64; y++) {
+            for (uint8_t x = 0; x < 128; x++) {
+                bool expected = x < image.width && y < image.height && image.lit[x + y * image.width];
+                wrongPixels += oled.getPixel(x, y) != expected;
+            }
+        }
+        CHECK_EQUAL(0, wrongPixels);
+
+        // Every mode and a spread of positions, including partly and fully off screen, over random content
+        uint8_t reference[1024];
+        uint32_t seed = n + 1;
+        uint32_t mismatches = 0;
+        for (uint16_t i = 0; i < 400; i++) {
+            int16_t x = (int16_t)(nextRandom(seed) % (128 + 2 * image.width)) - image.width;
+            int16_t y = (int16_t)(nextRandom(seed) % (64 + 2 * image.height)) - image.height;
+            BitmapMode mode = (BitmapMode)(i % 4);
+            uint32_t fill = nextRandom(seed);
+
+            fillRandom(oled, fill);
+            oled.drawBitmap(image.packed.data(), x, y, image.width, image.height, mode, false);
+            memcpy(reference, oled.getBuffer(), sizeof(reference));
+
+            fillRandom(oled, fill);
+            oled.drawCompressedBitmap(image.compressed, x, y, mode);
+            mismatches += memcmp(reference, oled.getBuffer(), sizeof(reference)) != 0;
+        }
+        CHECK_EQUAL(0, mismatches);
+
+        // Compression ratio, and decode time against the raw blit on this host
+        const uint32_t rounds = 2000;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < rounds; i++) {
+            oled.drawBitmap(image.packed.data(), 3, 2, image.width, image.height, BITMAP_COPY, false);
+        }
+        std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < rounds; i++) {
+            oled.drawCompressedBitmap(image.compressed, 3, 2, BITMAP_COPY);
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        char name[64];
+        snprintf(name, sizeof(name), "%s_raw_bytes", image.name);
+        metric(name, image.packed.size(), "bytes");
+        snprintf(name, sizeof(name), "%s_compressed_bytes", image.name);
+        metric(name, image.compressedSize, "bytes");
+        snprintf(name, sizeof(name), "%s_raw_host_ns", image.name);
+        metric(name, std::chrono::duration_cast<std::chrono::nanoseconds>(middle - start).count() / (double)rounds, "ns");
+        snprintf(name, sizeof(name), "%s_compressed_host_ns", image.name);
+        metric(name, std::chrono::duration_cast<std::chrono::nanoseconds>(end - middle).count() / (double)rounds, "ns");
+        totalRaw += image.packed.size();
+        totalCompressed += image.compressedSize;
+    }
+
+    metric("corpus_compressed_percent", 100.0 * totalCompressed / totalRaw, "percent");
+
+    return testResult();
+}
@@ -0,0 +1,94 @@
+// Hardware scrolling and start line changes show the buffer correctly on panels of every height, in both orientations
+// and with double buffering, including when the start line changes during a transfer
+
+#include "test.h"
+
+static uint32_t runScroll(uint8_t height, Orientation orientation, int8_t doubleBuffer, uint32_t seed) {
+    hostReset();
+    SH1106_OLED oled(128, height, 0x3C, orientation);
+    SH1106_Model model(128, height, 2);
+    oled.init();
+    if (doubleBuffer >= 0) {
+        CHECK(oled.enableDoubleBuffer(doubleBuffer));
+    }
+
+    uint32_t errors = 0;
+    for (uint16_t step = 0; step < 300; step++) {
+        switch (nextRandom(seed) % 5) {
+            case 0:
+            case 1:
+                drawRandomShape(oled, seed);
+                break;
+
+            case 2:
+                oled.scroll((int8_t)(nextRandom(seed) % 41) - 20);
+                break;
+
+            case 3:
+                oled.setStartLine(nextRandom(seed) % 64);
+                break;
+
+            case 4:
+                // Start line changes and drawing while a transfer is under way are picked up by the next one
+                oled.beginDisplay();
+                oled.pollDisplay();
+                oled.pollDisplay();
+                oled.scroll((int8_t)(nextRandom(seed) % 17) - 8);
+                drawRandomShape(oled, seed);
+                while (oled.pollDisplay());
+                break;
+        }
+
+        oled.display();
+        model.receive(Wire, 0x3C);
+        errors += countPanelErrors(model, oled);
+    }
+
+    return errors;
+}
+
+
+// Bytes sent per console-style line: scroll up a page, draw text on the new bottom line and display
+static double measureLineBytes(uint8_t height) {
+    hostReset();
+    SH1106_OLED oled(128, height, 0x3C);
+    SH1106_Model model(128, height, 2);
+    oled.init();
+    model.receive(Wire, 0x3C);
+
+    uint32_t errors = 0;
+    uint32_t sentBefore = oled.getBytesSent();
+    const uint8_t lines = 64;
+    for (uint8_t line = 0; line < lines; line++) {
+        oled.scroll(8);
+        uint8_t bottom = (oled.getStartLine() + height - 8) % height;
+        oled.print("LINE", 0, bottom + 1);
+        oled.display();
+        model.receive(Wire, 0x3C);
+        errors += countPanelErrors(model, oled);
+    }
+    CHECK_EQUAL(0, errors);
+
+    return (double)(oled.getBytesSent() - sentBefore) / lines;
+}
+
+
+int main() {
+    static const uint8_t heights[] = { 16, 32, 48, 64 };
+    for (uint8_t i = 0; i < sizeof(heights); i++) {
+        uint32_t errors = 0;
+        for (int8_t doubleBuffer = -1; doubleBuffer <= 1; doubleBuffer++) {
+            errors += runScroll(heights[i], ORIENTATION_NORMAL, doubleBuffer, 1 + i);
+            errors += runScroll(heights[i], ORIENTATION_FLIPPED, doubleBuffer, 11 + i);
+        }
+        CHECK_EQUAL(0, errors);
+
+        char name[64];
+        snprintf(name, sizeof(name), "height_%d_wrong_pixels", heights[i]);
+        metric(name, errors, "pixels");
+        snprintf(name, sizeof(name), "height_%d_bytes_per_scrolled_line", heights[i]);
+        metric(name, measureLineBytes(heights[i]), "bytes");
+    }
+
+    return testResult();
+}
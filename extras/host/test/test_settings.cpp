@@ -0,0 +1,116 @@
+// Hardware inverse, orientation and contrast changes leave the framebuffer untouched and cost a few command bytes,
+// sent together with the next display(), and contrast fades send only command bytes without blocking
+
+#include "test.h"
+
+// Counts data bytes in the transactions logged since a given position
+static uint32_t countDataBytes(size_t from) {
+    const std::vector<WireTransaction> &log = Wire.getLog();
+    uint32_t count = 0;
+    for (size_t i = from; i < log.size(); i++) {
+        size_t j = 0;
+        while (j < log[i].bytes.size()) {
+            uint8_t control = log[i].bytes[j++];
+            size_t end = (control & 0x80) ? min(j + 1, log[i].bytes.size()) : log[i].bytes.size();
+            if (control & 0x40) {
+                count += end - j;
+            }
+            j = end;
+        }
+    }
+
+    return count;
+}
+
+
+int main() {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    SH1106_Model model;
+    oled.init();
+    uint32_t seed = 3;
+    for (uint8_t i = 0; i < 40; i++) {
+        drawRandomShape(oled, seed);
+    }
+    oled.display();
+    model.receive(Wire);
+
+    // Inverse, flip and contrast together
+    uint8_t before[1024];
+    memcpy(before, oled.getBuffer(), sizeof(before));
+    size_t logStart = Wire.getLog().size();
+    uint32_t bytesBefore = oled.getBytesSent();
+    uint32_t transactionsBefore = oled.getTransactionCount();
+    uint32_t commandBytesBefore = model.commandBytes;
+    oled.setInverse(true);
+    oled.setOrientation(ORIENTATION_FLIPPED);
+    oled.setContrast(0x40);
+    CHECK_EQUAL(0, oled.getDirtyBytes());
+    oled.display();
+    model.receive(Wire);
+
+    uint32_t settingsTransactions = oled.getTransactionCount() - transactionsBefore;
+    uint32_t settingsBytes = oled.getBytesSent() - bytesBefore;
+    uint32_t settingsDataBytes = countDataBytes(logStart);
+    uint32_t settingsCommandBytes = model.commandBytes - commandBytesBefore;
+    CHECK_EQUAL(0, memcmp(before, oled.getBuffer(), sizeof(before)));
+    CHECK_EQUAL(1, settingsTransactions);
+    CHECK_EQUAL(0, settingsDataBytes);
+    CHECK(model.inverse);
+    CHECK_EQUAL(0x40, model.contrast);
+    CHECK_EQUAL(0, countPanelErrors(model, oled));
+
+    // The software inversion the hardware inverse replaces rewrites and resends the whole buffer
+    oled.setInverse(false);
+    oled.display();
+    bytesBefore = oled.getBytesSent();
+    oled.invert();
+    oled.display();
+    model.receive(Wire);
+    uint32_t softwareBytes = oled.getBytesSent() - bytesBefore;
+    CHECK_EQUAL(0, countPanelErrors(model, oled));
+    CHECK(softwareBytes > 1024);
+
+    // A fade polled every 5 ms sends one command-only transaction per contrast change and reaches its target
+    logStart = Wire.getLog().size();
+    transactionsBefore = oled.getTransactionCount();
+    oled.fadeContrast(0xF0, 100);
+    uint8_t polls = 1;
+    uint8_t lastContrast = oled.getContrast();
+    bool monotonic = true;
+    while (oled.updateContrastFade()) {
+        delay(5);
+        polls++;
+        monotonic &= oled.getContrast() >= lastContrast;
+        lastContrast = oled.getContrast();
+    }
+    model.receive(Wire);
+    uint32_t fadeTransactions = oled.getTransactionCount() - transactionsBefore;
+    CHECK(monotonic);
+    CHECK_EQUAL(0xF0, model.contrast);
+    CHECK_EQUAL(0, countDataBytes(logStart));
+    CHECK(fadeTransactions > 1 && fadeTransactions <= polls);
+
+    // During a transfer the fade's contrast is queued and sent once the frame is done
+    oled.drawRectFill(0, 0, 127, 63);
+    oled.beginDisplay();
+    oled.pollDisplay();
+    oled.fadeContrast(0x20, 0);
+    CHECK(!oled.updateContrastFade());
+    model.receive(Wire);
+    CHECK_EQUAL(0xF0, model.contrast);
+    while (oled.pollDisplay());
+    model.receive(Wire);
+    CHECK_EQUAL(0x20, model.contrast);
+    CHECK_EQUAL(0, countPanelErrors(model, oled));
+
+    metric("settings_transactions", settingsTransactions, "transactions");
+    metric("settings_bus_bytes", settingsBytes, "bytes");
+    metric("settings_command_bytes", settingsCommandBytes, "bytes");
+    metric("settings_data_bytes", settingsDataBytes, "bytes");
+    metric("software_invert_bus_bytes", softwareBytes, "bytes");
+    metric("fade_100ms_polls", polls, "polls");
+    metric("fade_100ms_transactions", fadeTransactions, "transactions");
+
+    return testResult();
+}
@@ -0,0 +1,239 @@
+// The sprite layer composites exactly like redrawing the background and every visible sprite in z order, sends only
+// the areas that changed, and keeps the application's clip rectangle
+
+#include "test.h"
+#include "SH1106_Sprites.h"
+#include <vector>
+
+#define SPRITE_FRAMES 3
+
+struct ReferenceSprite {
+    uint8_t id;
+    const uint8_t *frames;
+    const uint8_t *masks;
+    uint8_t width;
+    uint8_t height;
+    uint8_t frame;
+    int16_t x;
+    int16_t y;
+    int8_t z;
+    bool visible;
+};
+
+static uint8_t spriteData[MAX_SPRITES][SPRITE_FRAMES * 24 * 3];
+static uint8_t maskData[MAX_SPRITES][SPRITE_FRAMES * 24 * 3];
+static uint8_t background[1024];
+
+
+// Sorts by z, keeping the existing order of sprites with equal z
+static void sortByZ(std::vector<ReferenceSprite> &sprites) {
+    for (size_t i = 1; i < sprites.size(); i++) {
+        ReferenceSprite sprite = sprites[i];
+        size_t j = i;
+        for (; j > 0 && sprites[j - 1].z > sprite.z; j--) {
+            sprites[j] = sprites[j - 1];
+        }
+        sprites[j] = sprite;
+    }
+}
+
+
+// Draws the background and then every visible sprite, lowest z first, over the whole screen
+static void drawReference(SH1106_OLED &reference, std::vector<ReferenceSprite> &sprites) {
+    sortByZ(sprites);
+    reference.resetClipRect();
+    reference.drawBitmap(background, 0, 0, 128, 64, BITMAP_COPY, false);
+    for (size_t i = 0; i < sprites.size(); i++) {
+        const ReferenceSprite &sprite = sprites[i];
+        if (!sprite.visible) {
+            continue;
+        }
+
+        uint16_t frameOffset = sprite.frame * sprite.width * ((sprite.height + 7) / 8);
+        if (sprite.masks) {
+            reference.drawBitmapMasked(sprite.frames + frameOffset, sprite.masks + frameOffset, sprite.x, sprite.y, sprite.width, sprite.height);
+        } else {
+            reference.drawBitmap(sprite.frames + frameOffset, sprite.x, sprite.y, sprite.width, sprite.height);
+        }
+    }
+}
+
+
+static void addRandomSprite(SH1106_Sprites &layer, std::vector<ReferenceSprite> &sprites, uint32_t &seed) {
+    ReferenceSprite sprite;
+    sprite.width = 4 + nextRandom(seed) % 21;
+    sprite.height = 4 + nextRandom(seed) % 21;
+    sprite.x = (int16_t)(nextRandom(seed) % 150) - 12;
+    sprite.y = (int16_t)(nextRandom(seed) % 84) - 12;
+    sprite.z = nextRandom(seed) % 4;
+    sprite.frame = 0;
+    sprite.visible = true;
+    bool masked = nextRandom(seed) % 2;
+
+    uint8_t data = nextRandom(seed) % MAX_SPRITES;
+    sprite.frames = spriteData[data];
+    sprite.masks = masked ? maskData[data] : NULL;
+
+    sprite.id = layer.addSprite(sprite.frames, sprite.width, sprite.height, SPRITE_FRAMES, sprite.x, sprite.y, sprite.z, sprite.masks);
+    if (sprite.id != NO_SPRITE) {
+        sprites.push_back(sprite);
+    }
+}
+
+
+// Applies one random change to a sprite in the layer and in the reference list
+static void changeRandomSprite(SH1106_Sprites &layer, std::vector<ReferenceSprite> &sprites, uint32_t &seed) {
+    if (sprites.empty() || nextRandom(seed) % 12 == 0) {
+        addRandomSprite(layer, sprites, seed);
+        return;
+    }
+
+    size_t index = nextRandom(seed) % sprites.size();
+    ReferenceSprite &sprite = sprites[index];
+    switch (nextRandom(seed) % 6) {
+        case 0:
+        case 1:
+            sprite.x += (int16_t)(nextRandom(seed) % 9) - 4;
+            sprite.y += (int16_t)(nextRandom(seed) % 9) - 4;
+            sprite.x = constrain(sprite.x, -30, 140);
+            sprite.y = constrain(sprite.y, -30, 80);
+            layer.moveSprite(sprite.id, sprite.x, sprite.y);
+            break;
+
+        case 2:
+            sprite.frame = (sprite.frame + 1) % SPRITE_FRAMES;
+            layer.nextFrame(sprite.id);
+            break;
+
+        case 3:
+            sprite.visible = !sprite.visible;
+            layer.setVisible(sprite.id, sprite.visible);
+            break;
+
+        case 4:
+            sprite.z = nextRandom(seed) % 4;
+            layer.setZ(sprite.id, sprite.z);
+            break;
+
+        case 5:
+            layer.removeSprite(sprite.id);
+            sprites.erase(sprites.begin() + index);
+            break;
+    }
+}
+
+
+int main() {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    SH1106_OLED reference(128, 64, 0x3D);
+    SH1106_Model model;
+    oled.init();
+    reference.init();
+
+    uint32_t seed = 11;
+    for (uint8_t i = 0; i < MAX_SPRITES; i++) {
+        for (size_t j = 0; j < sizeof(spriteData[i]); j++) {
+            spriteData[i][j] = nextRandom(seed);
+            maskData[i][j] = nextRandom(seed) | spriteData[i][j];
+        }
+    }
+
+    for (uint8_t i = 0; i < 30; i++) {
+        drawRandomShape(oled, seed);
+    }
+    memcpy(background, oled.getBuffer(), sizeof(background));
+
+    SH1106_Sprites layer(oled);
+    CHECK(layer.captureBackground());
+    std::vector<ReferenceSprite> sprites;
+    for (uint8_t i = 0; i < 5; i++) {
+        addRandomSprite(layer, sprites, seed);
+    }
+    layer.update();
+    oled.display();
+    model.receive(Wire);
+
+    // Random changes, a few per frame, checked against a full composite after every update
+    uint32_t mismatches = 0;
+    uint32_t dirtyBytes = 0;
+    uint32_t busBytes = 0;
+    const uint16_t frames = 500;
+    for (uint16_t frame = 0; frame < frames; frame++) {
+        uint8_t changes = 1 + nextRandom(seed) % 3;
+        for (uint8_t i = 0; i < changes; i++) {
+            changeRandomSprite(layer, sprites, seed);
+        }
+
+        layer.update();
+        drawReference(reference, sprites);
+        mismatches += memcmp(oled.getBuffer(), reference.getBuffer(), 1024) != 0;
+
+        dirtyBytes += oled.getDirtyBytes();
+        uint32_t sentBefore = oled.getBytesSent();
+        oled.display();
+        busBytes += oled.getBytesSent() - sentBefore;
+    }
+    model.receive(Wire);
+    CHECK_EQUAL(0, mismatches);
+    CHECK_EQUAL(0, countPanelErrors(model, oled));
+
+    // Redrawing the whole screen each frame instead, as the sprite layer replaces
+    reference.display();
+    reference.clear();
+    drawReference(reference, sprites);
+    uint32_t fullDirtyBytes = reference.getDirtyBytes();
+    uint32_t sentBefore = reference.getBytesSent();
+    reference.display();
+    uint32_t fullBusBytes = reference.getBytesSent() - sentBefore;
+
+    // The application's clip rectangle is kept, and limits what the layer redraws
+    uint32_t outsideChanges = 0;
+    uint32_t insideMismatches = 0;
+    uint32_t clipChanged = 0;
+    for (uint16_t round = 0; round < 100; round++) {
+        uint8_t before[1024];
+        memcpy(before, oled.getBuffer(), sizeof(before));
+        int16_t clipX1 = nextRandom(seed) % 128;
+        int16_t clipY1 = nextRandom(seed) % 64;
+        int16_t clipX2 = min(127, clipX1 + (int)(nextRandom(seed) % 64));
+        int16_t clipY2 = min(63, clipY1 + (int)(nextRandom(seed) % 32));
+        oled.setClipRect(clipX1, clipY1, clipX2, clipY2);
+
+        for (uint8_t i = 0; i < 3; i++) {
+            changeRandomSprite(layer, sprites, seed);
+        }
+        layer.update();
+
+        int16_t x1, y1, x2, y2;
+        oled.getClipRect(x1, y1, x2, y2);
+        clipChanged += x1 != clipX1 || y1 != clipY1 || x2 != clipX2 || y2 != clipY2;
+
+        drawReference(reference, sprites);
+        for (uint8_t y = 0; y < 64; y++) {
+            for (uint8_t x = 0; x < 128; x++) {
+                if (x >= clipX1 && x <= clipX2 && y >= clipY1 && y <= clipY2) {
+                    insideMismatches += oled.getPixel(x, y) != reference.getPixel(x, y);
+                } else {
+                    outsideChanges += oled.getPixel(x, y) != (bool)(before[x + (y / 8) * 128] & (1 << (y & 7)));
+                }
+            }
+        }
+
+        // Bring the whole screen back in step for the next round
+        oled.resetClipRect();
+        memcpy(oled.getBuffer(), reference.getBuffer(), 1024);
+    }
+    CHECK_EQUAL(0, clipChanged);
+    CHECK_EQUAL(0, outsideChanges);
+    CHECK_EQUAL(0, insideMismatches);
+
+    metric("composite_mismatches", mismatches, "frames");
+    metric("sprite_dirty_bytes_per_frame", (double)dirtyBytes / frames, "bytes");
+    metric("sprite_bus_bytes_per_frame", (double)busBytes / frames, "bytes");
+    metric("full_redraw_dirty_bytes_per_frame", fullDirtyBytes, "bytes");
+    metric("full_redraw_bus_bytes_per_frame", fullBusBytes, "bytes");
+    metric("pixels_changed_outside_clip", outsideChanges, "pixels");
+
+    return testResult();
+}
@@ -0,0 +1,184 @@
+// printBox() wraps at spaces, splits words wider than the box and breaks at newlines, places each line by its
+// alignment and getTextWidth() without counting trailing spaces, and draws nothing outside the box or the clip rectangle
+
+#include "test.h"
+#include <string>
+#include <vector>
+
+// Lays a message out the way printBox() is documented to, with getTextWidth() as the only measurement
+static std::vector<std::string> wrapText(SH1106_OLED &oled, const std::string &msg, uint8_t w) {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (start < msg.size()) {
+        size_t paragraphEnd = msg.find('\n', start);
+        if (paragraphEnd == std::string::npos) {
+            paragraphEnd = msg.size();
+        }
+
+        // The longest run ending at the end of a word that fits, or else as many characters as fit, at least one
+        size_t end = start;
+        for (size_t i = start + 1; i <= paragraphEnd; i++) {
+            bool wordEnd = i == paragraphEnd || msg[i] == ' ';
+            if (wordEnd && oled.getTextWidth(msg.substr(start, i - start).c_str()) <= w) {
+                end = i;
+            }
+        }
+
+        if (end == start && start < paragraphEnd) {
+            end = start + 1;
+            while (end < paragraphEnd && oled.getTextWidth(msg.substr(start, end + 1 - start).c_str()) <= w) {
+                end++;
+            }
+        }
+
+        lines.push_back(msg.substr(start, end - start));
+        start = end;
+        if (start < msg.size() && msg[start] == '\n') {
+            start++;
+        } else {
+            while (start < msg.size() && msg[start] == ' ') {
+                start++;
+            }
+        }
+    }
+
+    return lines;
+}
+
+
+// Draws the laid out lines with print(), each placed by its width without trailing spaces, under the box's clip
+static void drawReference(SH1106_OLED &oled, const std::string &msg, uint8_t x, uint8_t y, uint8_t w, uint8_t h, TextAlign align, uint8_t scale) {
+    int16_t clipX1, clipY1, clipX2, clipY2;
+    oled.getClipRect(clipX1, clipY1, clipX2, clipY2);
+    int16_t x1 = max(clipX1, (int16_t)x);
+    int16_t y1 = max(clipY1, (int16_t)y);
+    int16_t x2 = min(clipX2, (int16_t)(x + w - 1));
+    int16_t y2 = min(clipY2, (int16_t)(y + h - 1));
+    if (w == 0 || h == 0 || x1 > x2 || y1 > y2) {
+        return;
+    }
+
+    oled.setClipRect(x1, y1, x2, y2);
+    std::vector<std::string> lines = wrapText(oled, msg, w);
+    int16_t lineY = y;
+    for (size_t i = 0; i < lines.size() && lineY < y + h && lineY <= 63; i++) {
+        std::string trimmed = lines[i].substr(0, lines[i].find_last_not_of(' ') + 1);
+        uint16_t lineWidth = min((uint16_t)w, oled.getTextWidth(trimmed.c_str()));
+        int16_t lineX = x;
+        if (align == ALIGN_CENTRE) {
+            lineX += (w - lineWidth) / 2;
+        } else if (align == ALIGN_RIGHT) {
+            lineX += w - lineWidth;
+        }
+
+        if (lineX <= 127) {
+            oled.print(lines[i].c_str(), lineX, lineY);
+        }
+        lineY += (font_5x4_monospace.height + 1) * scale;
+    }
+    oled.setClipRect(clipX1, clipY1, clipX2, clipY2);
+}
+
+
+static std::string randomText(uint32_t &seed) {
+    static const char letters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    std::string text;
+    uint8_t words = 1 + nextRandom(seed) % 10;
+    for (uint8_t i = 0; i < words; i++) {
+        uint8_t length = 1 + nextRandom(seed) % (nextRandom(seed) % 4 == 0 ? 14 : 6);
+        for (uint8_t j = 0; j < length; j++) {
+            text += letters[nextRandom(seed) % (sizeof(letters) - 1)];
+        }
+
+        if (nextRandom(seed) % 6 == 0) {
+            text += '\n';
+        } else {
+            text.append(1 + (nextRandom(seed) % 4 == 0 ? nextRandom(seed) % 3 : 0), ' ');
+        }
+    }
+
+    return text;
+}
+
+
+int main() {
+    hostReset();
+    SH1106_OLED oled(128, 64, 0x3C);
+    SH1106_OLED reference(128, 64, 0x3D);
+    oled.init();
+    reference.init();
+    oled.setFont(&font_5x4_monospace);
+    reference.setFont(&font_5x4_monospace);
+
+    // Trailing spaces before a wrap do not shift right and centred lines: "AB" ends at the right edge of the box, and the
+    // word too wide for the box is split
+    oled.printBox("AB   CDEFGHIJKL", 10, 10, 30, 20, ALIGN_RIGHT);
+    reference.print("AB", 10 + 30 - reference.getTextWidth("AB"), 10);
+    reference.print("CDEFGH", 10 + 30 - reference.getTextWidth("CDEFGH"), 16);
+    reference.print("IJKL", 10 + 30 - reference.getTextWidth("IJKL"), 22);
+    CHECK_EQUAL(0, memcmp(oled.getBuffer(), reference.getBuffer(), 1024));
+
+    uint32_t seed = 9;
+    uint32_t wrongPixels = 0;
+    uint32_t outsideChanges = 0;
+    uint32_t clipChanged = 0;
+    uint32_t lines = 0;
+    for (uint16_t step = 0; step < 3000; step++) {
+        oled.clear();
+        for (uint8_t i = 0; i < 4; i++) {
+            drawRandomShape(oled, seed);
+        }
+        memcpy(reference.getBuffer(), oled.getBuffer(), 1024);
+
+        // A box that may run off the screen, sometimes under an outer clip rectangle
+        std::string text = randomText(seed);
+        uint8_t x = nextRandom(seed) % 120;
+        uint8_t y = nextRandom(seed) % 60;
+        uint8_t w = 1 + nextRandom(seed) % 100;
+        uint8_t h = 1 + nextRandom(seed) % 50;
+        TextAlign align = (TextAlign)(nextRandom(seed) % 3);
+        uint8_t scale = nextRandom(seed) % 4 == 0 ? 2 : 1;
+        oled.setTextScale(scale);
+        reference.setTextScale(scale);
+        if (nextRandom(seed) % 2) {
+            int16_t x1 = nextRandom(seed) % 128;
+            int16_t y1 = nextRandom(seed) % 64;
+            oled.setClipRect(x1, y1, x1 + nextRandom(seed) % 80, y1 + nextRandom(seed) % 40);
+        } else {
+            oled.resetClipRect();
+        }
+        int16_t clipX1, clipY1, clipX2, clipY2;
+        oled.getClipRect(clipX1, clipY1, clipX2, clipY2);
+        reference.setClipRect(clipX1, clipY1, clipX2, clipY2);
+
+        uint8_t before[1024];
+        memcpy(before, oled.getBuffer(), sizeof(before));
+        oled.printBox(text.c_str(), x, y, w, h, align);
+        drawReference(reference, text, x, y, w, h, align, scale);
+        lines += wrapText(reference, text, w).size();
+
+        int16_t x1, y1, x2, y2;
+        oled.getClipRect(x1, y1, x2, y2);
+        clipChanged += x1 != clipX1 || y1 != clipY1 || x2 != clipX2 || y2 != clipY2;
+
+        for (uint8_t py = 0; py < 64; py++) {
+            for (uint8_t px = 0; px < 128; px++) {
+                bool inside = px >= max((int16_t)x, clipX1) && px <= min(x + w - 1, (int)clipX2) && py >= max((int16_t)y, clipY1) && py <= min(y + h - 1, (int)clipY2);
+                if (inside) {
+                    wrongPixels += oled.getPixel(px, py) != reference.getPixel(px, py);
+                } else {
+                    outsideChanges += oled.getPixel(px, py) != (bool)(before[px + (py / 8) * 128] & (1 << (py & 7)));
+                }
+            }
+        }
+    }
+
+    CHECK_EQUAL(0, wrongPixels);
+    CHECK_EQUAL(0, outsideChanges);
+    CHECK_EQUAL(0, clipChanged);
+    metric("wrong_pixels", wrongPixels, "pixels");
+    metric("pixels_changed_outside_box", outsideChanges, "pixels");
+    metric("lines_laid_out", lines, "lines");
+
+    return testResult();
+}
@@ -0,0 +1,152 @@
+// The I2C, SPI, recording and background transports deliver the same display RAM, and the driver honours partial sends
+
+#include "test.h"
+#include "SH1106_RecordingTransport.h"
+
+static void drawScene(SH1106_OLED &oled) {
+    oled.drawCircleFill(30, 30, 20);
+    oled.drawLine(0, 63, 127, 0);
+    oled.print("TRANSPORT", 50, 50);
+    oled.drawRect(100, 4, 20, 12);
+}
+
+
+static bool sameRam(const SH1106_Model &a, const SH1106_Model &b) {
+    for (uint8_t page = 0; page < MODEL_PAGES; page++) {
+        for (uint8_t column = 0; column < MODEL_COLUMNS; column++) {
+            if (a.getRam(page, column) != b.getRam(page, column)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+// Background transport whose transfers, once held, finish only when the test says so
+class ManualAsyncTransport : public SH1106_AsyncTransport {
+    public:
+        ManualAsyncTransport() : recorder(8), hold(false) {}
+
+        virtual void begin() {}
+
+        virtual void sendCommands(const uint8_t *commands, uint8_t count) {
+            recorder.sendCommands(commands, count);
+        }
+
+        virtual uint16_t sendData(uint8_t page, uint8_t column, const uint8_t *data, uint16_t count) {
+            if (hold) {
+                startTransfer();
+            }
+            return recorder.sendData(page, column, data, count);
+        }
+
+        SH1106_RecordingTransport recorder;
+        bool hold;
+};
+
+
+class CountedTransport : public SH1106_RecordingTransport {
+    public:
+        CountedTransport(int &destroyed) : destroyed(destroyed) {}
+        ~CountedTransport() { destroyed++; }
+
+    private:
+        int &destroyed;
+};
+
+
+int main() {
+    // Reference: the built in I2C transport on Wire
+    hostReset();
+    SH1106_OLED i2cOled(128, 64, 0x3C);
+    SH1106_Model i2cModel;
+    i2cOled.init();
+    drawScene(i2cOled);
+    i2cOled.display();
+    i2cModel.receive(Wire);
+    CHECK_EQUAL(0, countPanelErrors(i2cModel, i2cOled));
+
+    hostReset();
+    SH1106_SPI spi(8, 10);
+    SPI.attach(8, 10);
+    SH1106_OLED spiOled(128, 64, spi);
+    SH1106_Model spiModel;
+    spiOled.init();
+    drawScene(spiOled);
+    spiOled.display();
+    spiModel.receive(SPI);
+    CHECK(sameRam(i2cModel, spiModel));
+    CHECK_EQUAL(0, countPanelErrors(spiModel, spiOled));
+
+    hostReset();
+    SH1106_RecordingTransport recorder;
+    SH1106_OLED recordedOled(128, 64, recorder);
+    SH1106_Model recordedModel;
+    recordedOled.init();
+    CHECK_EQUAL(1, recorder.beginCount);
+    drawScene(recordedOled);
+    recordedOled.display();
+    recorder.replay(recordedModel);
+    CHECK(sameRam(i2cModel, recordedModel));
+    CHECK_EQUAL(0, Wire.getLog().size());
+    metric("i2c_scene_transactions", i2cOled.getTransactionCount(), "transactions");
+    metric("spi_scene_transactions", spiOled.getTransactionCount(), "transactions");
+    metric("recorded_scene_records", recorder.records.size(), "records");
+
+    // A transport that takes 16 bytes at a time gets exactly one sendData() per pollDisplay()
+    SH1106_RecordingTransport chunked(16);
+    SH1106_OLED chunkedOled(128, 64, chunked);
+    SH1106_Model chunkedModel;
+    chunkedOled.init();
+    drawScene(chunkedOled);
+    chunked.clear();
+    chunkedOled.beginDisplay();
+    uint32_t polls = 0;
+    bool partial = true;
+    while (chunkedOled.isBusy()) {
+        size_t before = chunked.records.size();
+        chunkedOled.pollDisplay();
+        polls++;
+        partial = partial && chunked.records.size() - before <= 1;
+    }
+    CHECK(partial);
+    for (size_t i = 0; i < chunked.records.size(); i++) {
+        CHECK(!chunked.records[i].isData || chunked.records[i].bytes.size() <= 16);
+    }
+    CHECK_EQUAL(polls, chunked.records.size());
+
+    // A background transport is never given new data until its transfer completes
+    ManualAsyncTransport async;
+    SH1106_OLED asyncOled(128, 64, async);
+    SH1106_Model asyncModel;
+    asyncOled.init();
+    drawScene(asyncOled);
+    async.hold = true;
+    asyncOled.beginDisplay();
+    uint32_t idlePolls = 0;
+    bool waited = true;
+    while (asyncOled.isBusy()) {
+        asyncOled.pollDisplay();
+        size_t sent = async.recorder.records.size();
+        for (uint8_t i = 0; i < 3; i++) {
+            CHECK(asyncOled.pollDisplay());
+            idlePolls++;
+        }
+        waited = waited && async.recorder.records.size() == sent;
+        async.transferComplete();
+    }
+    CHECK(waited);
+    CHECK(idlePolls > 0);
+    async.recorder.replay(asyncModel);
+    CHECK(sameRam(i2cModel, asyncModel));
+
+    // Transports can be destroyed through a base pointer
+    int destroyed = 0;
+    SH1106_Transport *transport = new CountedTransport(destroyed);
+    delete transport;
+    CHECK_EQUAL(1, destroyed);
+
+    return testResult();
+}
@@ -0,0 +1,89 @@
+// The Q15 sine and cosine match libm for any whole-degree angle, and are compared with the original float table
+
+#include "test.h"
+#include <math.h>
+#include <chrono>
+
+// The original float table and lookups, which only handled 0 to 360 degrees
+static float sineTable[91];
+
+static float getSineAngle(int angle) {
+    if (angle <= 90) return sineTable[angle];
+    if (angle < 180) return sineTable[180 - angle];
+    if (angle <= 270) return -sineTable[angle - 180];
+    return -sineTable[360 - angle];
+}
+
+
+static float getCosineAngle(int angle) {
+    if (angle <= 90) return sineTable[90 - angle];
+    if (angle < 180) return -sineTable[angle - 90];
+    if (angle <= 270) return -sineTable[270 - angle];
+    return sineTable[angle - 270];
+}
+
+
+// Nanoseconds per lookup pair on this host, over angles 0 to 359 so the original functions stay in range
+template <typename Lookup>
+static double timeLookups(Lookup lookup) {
+    volatile int32_t sink = 0;
+    const uint32_t rounds = 20000;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (int16_t angle = 0; angle < 360; angle++) {
+            sink = sink + lookup(angle);
+        }
+    }
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return (double)elapsed / (rounds * 360.0);
+}
+
+
+static int32_t lookupQ15(int16_t angle) {
+    return (int32_t)getSineQ15(angle) * 31 + (int32_t)getCosineQ15(angle) * 17;
+}
+
+
+static int32_t lookupFloat(int16_t angle) {
+    return (int32_t)(getSineAngle(angle) * 31 * 32767) + (int32_t)(getCosineAngle(angle) * 17 * 32767);
+}
+
+
+int main() {
+    for (uint8_t i = 0; i <= 90; i++) {
+        sineTable[i] = sin(i * M_PI / 180.0);
+    }
+
+    // Every angle in four turns either side of zero, including negative angles
+    double maxError = 0;
+    for (int32_t angle = -1440; angle <= 1440; angle++) {
+        double radians = angle * M_PI / 180.0;
+        maxError = max(maxError, fabs(getSineQ15(angle) / 32767.0 - sin(radians)));
+        maxError = max(maxError, fabs(getCosineQ15(angle) / 32767.0 - cos(radians)));
+    }
+    CHECK(maxError <= 0.5 / 32767 + 1e-9);
+
+    // Angles far outside a turn reduce the same way as small ones
+    CHECK_EQUAL(getSineQ15(30), getSineQ15(30 + 360L * 1000));
+    CHECK_EQUAL(getSineQ15(-30), -getSineQ15(30));
+    CHECK_EQUAL(32767, getSineQ15(90));
+    CHECK_EQUAL(-32767, getCosineQ15(180));
+    CHECK_EQUAL(0, getSineQ15(0));
+
+    double maxFloatError = 0;
+    for (int16_t angle = 0; angle <= 360; angle++) {
+        double radians = angle * M_PI / 180.0;
+        maxFloatError = max(maxFloatError, fabs(getSineAngle(angle) - sin(radians)));
+        maxFloatError = max(maxFloatError, fabs(getCosineAngle(angle) - cos(radians)));
+    }
+
+    metric("q15_max_error", maxError, "fraction");
+    metric("q15_max_error_lsb", maxError * 32767, "lsb");
+    metric("float_table_max_error", maxFloatError, "fraction");
+    metric("q15_table_bytes", sizeof(sine_q15), "bytes");
+    metric("float_table_bytes", sizeof(sineTable), "bytes");
+    metric("q15_host_ns_per_pair", timeLookups(lookupQ15), "ns");
+    metric("float_host_ns_per_pair", timeLookups(lookupFloat), "ns");
+
+    return testResult();
+}
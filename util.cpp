@@ -1,6 +1,6 @@
 #ifndef UTIL_C
 #define UTIL_C
-#include <sine_lut.cpp>
+#include "sine_lut.cpp"
 
 static void clamp(uint8_t &value, uint8_t lowerBound, uint8_t upperBound) {
     if (value < lowerBound) {
@@ -22,41 +22,66 @@ static void swap(T &a, T &b) {
     b = b - a;
 }
 
-static float getSineAngle(int angle) {
-    if (angle >= 0 && angle <= 90) { 
-        return pgm_read_float(&sine_lut[angle]);
+static int16_t getSineQ15(int32_t angle) {
+    angle %= 360;
+    if (angle < 0) {
+        angle += 360;
     }
 
-    if (angle > 90 && angle < 180) {
-        return pgm_read_float(&sine_lut[180 - angle]);
+    if (angle <= 90) {
+        return (int16_t)pgm_read_word(&sine_q15[angle]);
     }
 
-    if (angle >= 180 && angle <= 270) {
-        return -pgm_read_float(&sine_lut[angle - 180]);
+    if (angle <= 180) {
+        return (int16_t)pgm_read_word(&sine_q15[180 - angle]);
     }
 
-    if (angle > 270 && angle <= 360) {
-        return -pgm_read_float(&sine_lut[360 - angle]);
+    if (angle <= 270) {
+        return -(int16_t)pgm_read_word(&sine_q15[angle - 180]);
     }
+
+    return -(int16_t)pgm_read_word(&sine_q15[360 - angle]);
 }
 
 
-static float getCosineAngle(int angle) {
-    if (angle >= 0 && angle <= 90) { 
-        return pgm_read_float(&sine_lut[90 - angle]);
-    }
+static int16_t getCosineQ15(int32_t angle) {
+    return getSineQ15(angle + 90);
+}
 
-    if (angle > 90 && angle < 180) {
-        return -pgm_read_float(&sine_lut[angle - 90]);
-    }
+// Angular range of an arc, stored as direction vectors scaled by 256 so points can be tested with integer cross products
+struct ArcBounds {
+    int16_t startX;
+    int16_t startY;
+    int16_t endX;
+    int16_t endY;
+    bool major;
+    bool full;
+};
 
-    if (angle >= 180 && angle <= 270) {
-        return -pgm_read_float(&sine_lut[270 - angle]);
+static ArcBounds getArcBounds(uint16_t startAngle, uint16_t endAngle) {
+    ArcBounds arc;
+    uint16_t sweep = (endAngle % 360 + 360 - startAngle % 360) % 360;
+    arc.full = (sweep == 0);
+    arc.major = (sweep > 180);
+    arc.startX = (getCosineQ15(startAngle) + 64) >> 7;
+    arc.startY = (getSineQ15(startAngle) + 64) >> 7;
+    arc.endX = (getCosineQ15(endAngle) + 64) >> 7;
+    arc.endY = (getSineQ15(endAngle) + 64) >> 7;
+    return arc;
+}
+
+static bool isInArc(const ArcBounds &arc, int16_t x, int16_t y) {
+    if (arc.full) {
+        return true;
     }
 
-    if (angle > 270 && angle <= 360) {
-        return pgm_read_float(&sine_lut[angle - 270]);
+    int32_t fromStart = (int32_t)arc.startX * y - (int32_t)arc.startY * x;
+    int32_t toEnd = (int32_t)x * arc.endY - (int32_t)y * arc.endX;
+    if (arc.major) {
+        return fromStart >= 0 || toEnd >= 0;
     }
+
+    return fromStart >= 0 && toEnd >= 0;
 }
 
 static uint8_t getClampedRadius(uint8_t width, uint8_t height, uint8_t radius) {